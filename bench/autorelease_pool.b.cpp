@@ -0,0 +1,57 @@
+#include <scope_exit/autorelease_pool.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Cost per object of creating and releasing N short-lived heap objects per scope: autorelease_pool against one
+// unique_ptr per object.
+
+namespace
+{
+
+struct node
+{
+    explicit node(std::size_t v)
+        : value{v}
+    {}
+
+    std::size_t value;
+    std::string name = "short";
+};
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000;
+    char name[64];
+
+    for (std::size_t objects : {8, 64, 512})
+    {
+        std::snprintf(name, sizeof name, "unique_ptr, %zu objects", objects);
+        std::vector<std::unique_ptr<node>> nodes;
+        nodes.reserve(objects);
+        bench::report(name, bench::ns_per_op(iterations, [&](std::size_t) {
+            for (std::size_t i = 0; i != objects; ++i)
+            {
+                nodes.push_back(std::make_unique<node>(i));
+            }
+            bench::do_not_optimize(nodes.data());
+            nodes.clear();
+        }) / static_cast<double>(objects));
+
+        std::snprintf(name, sizeof name, "autorelease_pool, %zu objects", objects);
+        bench::report(name, bench::ns_per_op(iterations, [&](std::size_t) {
+            scope_exit_v1::autorelease_pool pool;
+            for (std::size_t i = 0; i != objects; ++i)
+            {
+                bench::do_not_optimize(pool.make<node>(i));
+            }
+        }) / static_cast<double>(objects));
+    }
+}
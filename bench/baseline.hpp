@@ -0,0 +1,197 @@
+#pragma once
+
+/// Purpose: store benchmark trials as JSON baselines and read them back for comparison.
+///
+/// A baseline is one JSON object mapping benchmark names to the nanoseconds per call of each trial:
+/// ```
+///   {
+///     "scope(exit)": [0.71, 0.70, 0.72],
+///     "scope(failure), unwinding": [1184.2, 1190.5, 1179.9]
+///   }
+/// ```
+/// The reader accepts exactly what the writer produces, plus whitespace; anything else yields an empty baseline.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+using results = std::map<std::string, std::vector<double>>;
+
+inline bool save_baseline(char const * path, results const & all)
+{
+    std::FILE * out = std::fopen(path, "w");
+    if (out == nullptr)
+    {
+        return false;
+    }
+    std::fprintf(out, "{");
+    char const * separator = "\n";
+    for (auto const & [name, samples] : all)
+    {
+        std::fprintf(out, "%s  \"", separator);
+        for (char c : name)
+        {
+            if (c == '"' || c == '\\')
+            {
+                std::fputc('\\', out);
+            }
+            std::fputc(c, out);
+        }
+        std::fprintf(out, "\": [");
+        for (std::size_t i = 0; i != samples.size(); ++i)
+        {
+            std::fprintf(out, "%s%.17g", i == 0 ? "" : ", ", samples[i]);
+        }
+        std::fprintf(out, "]");
+        separator = ",\n";
+    }
+    std::fprintf(out, "\n}\n");
+    return std::fclose(out) == 0;
+}
+
+namespace detail
+{
+
+class baseline_parser
+{
+public:
+    explicit baseline_parser(std::string text)
+        : text_{std::move(text)}
+    {}
+
+    bool parse(results & all)
+    {
+        if (!accept('{'))
+        {
+            return false;
+        }
+        if (peek() == '}')
+        {
+            return true;
+        }
+        do
+        {
+            std::string name;
+            std::vector<double> samples;
+            if (!string(name) || !accept(':') || !array(samples))
+            {
+                return false;
+            }
+            all[name] = std::move(samples);
+        } while (accept(','));
+        return accept('}');
+    }
+
+private:
+    char peek()
+    {
+        while (pos_ != text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+        {
+            ++pos_;
+        }
+        return pos_ != text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool accept(char c)
+    {
+        if (peek() != c)
+        {
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    bool string(std::string & out)
+    {
+        if (!accept('"'))
+        {
+            return false;
+        }
+        for (; pos_ != text_.size(); ++pos_)
+        {
+            char c = text_[pos_];
+            if (c == '"')
+            {
+                ++pos_;
+                return true;
+            }
+            if (c == '\\' && ++pos_ == text_.size())
+            {
+                break;
+            }
+            out += text_[pos_];
+        }
+        return false;
+    }
+
+    bool array(std::vector<double> & out)
+    {
+        if (!accept('['))
+        {
+            return false;
+        }
+        if (accept(']'))
+        {
+            return true;
+        }
+        do
+        {
+            peek();
+            char const * begin = text_.c_str() + pos_;
+            char * end = nullptr;
+            double value = std::strtod(begin, &end);
+            if (end == begin)
+            {
+                return false;
+            }
+            pos_ += static_cast<std::size_t>(end - begin);
+            out.push_back(value);
+        } while (accept(','));
+        return accept(']');
+    }
+
+    std::string text_;
+    std::size_t pos_ = 0;
+};
+
+}  // namespace detail
+
+/// Read a baseline written by `save_baseline`.  Returns an empty map if the file is missing or malformed.
+inline results load_baseline(char const * path)
+{
+    std::FILE * in = std::fopen(path, "r");
+    if (in == nullptr)
+    {
+        return {};
+    }
+    std::string text;
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof buffer, in)) != 0;)
+    {
+        text.append(buffer, n);
+    }
+    std::fclose(in);
+
+    results all;
+    if (!detail::baseline_parser{std::move(text)}.parse(all))
+    {
+        return {};
+    }
+    return all;
+}
+
+}  // namespace bench
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,91 @@
+#include <scope_exit/batched_notifier.hpp>
+
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Cost per message of waking a consumer thread that polls the eventfd: a write per message with
+// `scope(exit) { notifier.notify(); }` against one write per batch with `scope(notify_batch, notifier)`, for several
+// batch sizes.  Reported are the time, the eventfd writes and the consumer wakeups per message.
+
+namespace
+{
+
+struct consumer
+{
+    explicit consumer(scope_exit_v1::batched_notifier & notifier)
+        : thread_{[this, &notifier] {
+            while (!stop_.load())
+            {
+                if (auto n = notifier.wait(10))
+                {
+                    received_ += n;
+                    ++wakeups_;
+                }
+            }
+        }}
+    {}
+
+    ~consumer()
+    {
+        stop_.store(true);
+        thread_.join();
+    }
+
+    std::uint64_t wakeups() const { return wakeups_.load(); }
+
+private:
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> received_{0};
+    std::atomic<std::uint64_t> wakeups_{0};
+    std::thread thread_;
+};
+
+template <typename Batch>
+void run(char const * style, std::size_t batch_size, std::size_t messages, Batch && batch)
+{
+    scope_exit_v1::batched_notifier notifier;
+    double ns = 0;
+    std::uint64_t wakeups = 0;
+    {
+        consumer c{notifier};
+        ns = bench::ns_per_op(messages / batch_size, [&](std::size_t) { batch(notifier, batch_size); }) /
+             static_cast<double>(batch_size);
+        wakeups = c.wakeups();
+    }
+    double const n = static_cast<double>(messages / batch_size * batch_size);
+    std::printf("%-20s %6zu %12.1f %16.3f %18.3f\n", style, batch_size, ns,
+                static_cast<double>(notifier.writes()) / n, static_cast<double>(wakeups) / n);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    std::atomic<std::uint64_t> queued{0};
+
+    std::printf("%-20s %6s %12s %16s %18s\n", "style", "batch", "ns/message", "writes/message", "wakeups/message");
+    for (std::size_t batch_size : {1, 8, 64, 512})
+    {
+        run("notify per message", batch_size, messages, [&](auto & notifier, std::size_t n) {
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                scope(exit) { notifier.notify(); };
+                queued.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        run("scope(notify_batch)", batch_size, messages, [&](auto & notifier, std::size_t n) {
+            scope(notify_batch, notifier);
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                scope(exit) { notifier.notify(); };
+                queued.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    bench::do_not_optimize(queued);
+}
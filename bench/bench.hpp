@@ -0,0 +1,206 @@
+#pragma once
+
+/// Purpose: minimal timing helpers shared by the benchmark executables.
+///
+/// `ns_per_op` and `parallel_ns_per_op` time one run.  For numbers compared between builds, `pin_to_cpu` keeps the
+/// thread on one core, `trials` warms the operation up, sizes a batch to a fixed duration and times repeated batches,
+/// and `mann_whitney_p` tells whether two sets of trials differ by more than noise.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace bench
+{
+
+/// Prevent the compiler from optimizing away a value.
+template <typename T>
+inline void do_not_optimize(T const & value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<T const volatile *>(&value));
+#endif
+}
+
+/// Run `op(i)` for i in [0, iterations) and return the average time per call in nanoseconds.
+template <typename Op>
+double ns_per_op(std::size_t iterations, Op && op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        op(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+/// Run `op()` `iterations` times on each of `threads` threads and return the wall time per call in nanoseconds.
+template <typename Op>
+double parallel_ns_per_op(unsigned threads, std::size_t iterations, Op op)
+{
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&] {
+            for (std::size_t i = 0; i != iterations; ++i)
+            {
+                op();
+            }
+        });
+    }
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * threads);
+}
+
+/// Pin the calling thread to `cpu`, or to the CPU it is running on if `cpu` is negative.  Linux only; returns false
+/// where it is unsupported or refused.
+inline bool pin_to_cpu(int cpu = -1)
+{
+#if defined(__linux__)
+    if (cpu < 0)
+    {
+        cpu = ::sched_getcpu();
+    }
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof set, &set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+struct trial_options
+{
+    unsigned trials = 15;
+    std::chrono::milliseconds trial_time{20};
+};
+
+/// Warm `op(i)` up while doubling the batch size until one batch takes `trial_time`, then time `trials` batches of
+/// that size.  Returns the nanoseconds per call of each batch.
+template <typename Op>
+std::vector<double> trials(Op && op, trial_options const & options = {})
+{
+    std::size_t batch = 1;
+    double const target_ns = std::chrono::duration<double, std::nano>(options.trial_time).count();
+    while (ns_per_op(batch, op) * static_cast<double>(batch) < target_ns && batch < (std::size_t{1} << 40))
+    {
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.trials);
+    for (unsigned t = 0; t != options.trials; ++t)
+    {
+        samples.push_back(ns_per_op(batch, op));
+    }
+    return samples;
+}
+
+inline double median(std::vector<double> samples)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+    auto const mid = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() / 2);
+    std::nth_element(samples.begin(), mid, samples.end());
+    if (samples.size() % 2 != 0)
+    {
+        return *mid;
+    }
+    return (*mid + *std::max_element(samples.begin(), mid)) / 2;
+}
+
+/// Two-sided p-value of the Mann-Whitney U test that `a` and `b` come from the same distribution, using the normal
+/// approximation with tie and continuity corrections (fine from about 8 samples each).  Unlike a t-test it does not
+/// assume normally distributed timings, and a few outliers from preemption do not dominate it.
+inline double mann_whitney_p(std::vector<double> const & a, std::vector<double> const & b)
+{
+    if (a.empty() || b.empty())
+    {
+        return 1.0;
+    }
+
+    // rank the pooled samples, averaging the ranks of ties
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(a.size() + b.size());
+    for (double x : a)
+    {
+        pooled.emplace_back(x, true);
+    }
+    for (double x : b)
+    {
+        pooled.emplace_back(x, false);
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    double const n1 = static_cast<double>(a.size());
+    double const n2 = static_cast<double>(b.size());
+    double const n = n1 + n2;
+    double rank_sum_a = 0;
+    double ties = 0;  // sum of t^3 - t over groups of t tied samples
+    for (std::size_t i = 0; i != pooled.size();)
+    {
+        std::size_t j = i;
+        while (j != pooled.size() && pooled[j].first == pooled[i].first)
+        {
+            ++j;
+        }
+        double const t = static_cast<double>(j - i);
+        double const rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2;
+        for (std::size_t k = i; k != j; ++k)
+        {
+            rank_sum_a += pooled[k].second ? rank : 0;
+        }
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double const u = rank_sum_a - n1 * (n1 + 1) / 2;
+    double const mean = n1 * n2 / 2;
+    double const variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0)
+    {
+        return 1.0;
+    }
+    double const z = std::max(0.0, std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+inline void report(char const * name, double ns)
+{
+    std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name, ns, ns > 0 ? 1e9 / ns : 0.0);
+}
+
+}  // namespace bench
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
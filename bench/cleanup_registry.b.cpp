@@ -0,0 +1,61 @@
+#include <scope_exit/cleanup_registry.hpp>
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+// Batch writer pattern: N records spread over a few files, with a flush registered per record.  Redundant
+// scope(exit) guards flush N times; cleanup_registry flushes once per file.
+
+namespace
+{
+
+struct file
+{
+    int pending = 0;
+};
+
+void flush(file & f)
+{
+    // stands in for a flush syscall (~100ns of work)
+    for (int i = 0; i != 100; ++i)
+    {
+        bench::do_not_optimize(i);
+    }
+    f.pending = 0;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const batches = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000;
+    file files[4];
+    char name[64];
+
+    for (std::size_t records : {16, 256})
+    {
+        std::snprintf(name, sizeof name, "scope(exit) per record, %zu records", records);
+        bench::report(name, bench::ns_per_op(batches, [&](std::size_t) {
+            for (std::size_t i = 0; i != records; ++i)
+            {
+                file & f = files[i % 4];
+                ++f.pending;
+                scope(exit) { flush(f); };
+            }
+        }) / static_cast<double>(records));
+
+        std::snprintf(name, sizeof name, "cleanup_registry, %zu records", records);
+        bench::report(name, bench::ns_per_op(batches, [&](std::size_t) {
+            scope_exit_v1::cleanup_registry<> cleanups;
+            for (std::size_t i = 0; i != records; ++i)
+            {
+                file & f = files[i % 4];
+                ++f.pending;
+                cleanups.defer(&f, [&f] { flush(f); });
+            }
+        }) / static_cast<double>(records));
+    }
+}
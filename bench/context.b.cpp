@@ -0,0 +1,109 @@
+#include <scope_exit/context.hpp>
+
+#include "bench.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Push, look up and pop request metadata: context_guard against scope(exit) popping a thread_local std::vector.
+
+namespace
+{
+
+struct request_id
+{
+    unsigned long value;
+};
+
+struct tenant
+{
+    std::string name;
+};
+
+struct deadline
+{
+    std::chrono::steady_clock::time_point at;
+};
+
+template <typename T>
+std::vector<T> & vector_stack()
+{
+    static thread_local std::vector<T> stack;
+    return stack;
+}
+
+template <typename T>
+T const * vector_current()
+{
+    auto & stack = vector_stack<T>();
+    return stack.empty() ? nullptr : &stack.back();
+}
+
+// Logging code has to handle a missing context, so both lookups check for it.
+template <typename T, typename Lookup>
+void touch(Lookup lookup)
+{
+    if (T const * value = lookup())
+    {
+        bench::do_not_optimize(*value);
+    }
+}
+
+void log_vector()
+{
+    touch<request_id>(vector_current<request_id>);
+    touch<tenant>(vector_current<tenant>);
+    touch<deadline>(vector_current<deadline>);
+}
+
+void log_context()
+{
+    touch<request_id>(scope_exit_v1::current_context<request_id>);
+    touch<tenant>(scope_exit_v1::current_context<tenant>);
+    touch<deadline>(scope_exit_v1::current_context<deadline>);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5'000'000;
+    auto const at = std::chrono::steady_clock::now();
+
+    bench::report("thread_local vector, push/pop 3 + lookup", bench::ns_per_op(iterations, [&](std::size_t i) {
+                      vector_stack<request_id>().push_back({i});
+                      scope(exit) { vector_stack<request_id>().pop_back(); };
+                      vector_stack<tenant>().push_back({"acme"});
+                      scope(exit) { vector_stack<tenant>().pop_back(); };
+                      vector_stack<deadline>().push_back({at});
+                      scope(exit) { vector_stack<deadline>().pop_back(); };
+                      log_vector();
+                  }));
+
+    bench::report("context_guard, push/pop 3 + lookup", bench::ns_per_op(iterations, [&](std::size_t i) {
+                      scope(context, request_id, i);
+                      scope(context, tenant, "acme");
+                      scope(context, deadline, at);
+                      log_context();
+                  }));
+
+    // lookups only, with the context already in place
+    vector_stack<request_id>().push_back({1});
+    vector_stack<tenant>().push_back({"acme"});
+    vector_stack<deadline>().push_back({at});
+    bench::report("thread_local vector, lookup 3", bench::ns_per_op(iterations, [](std::size_t) { log_vector(); }));
+
+    scope(context, request_id, 1ul);
+    scope(context, tenant, "acme");
+    scope(context, deadline, at);
+    bench::report("context_guard, lookup 3", bench::ns_per_op(iterations, [](std::size_t) { log_context(); }));
+
+    // hand-off to a pool task: capture on one side, restore on the other
+    bench::report("capture + restore 3", bench::ns_per_op(iterations, [](std::size_t) {
+                      auto ctx = scope_exit_v1::capture_context<request_id, tenant, deadline>();
+                      auto restored = ctx.restore();
+                      log_context();
+                  }));
+}
@@ -0,0 +1,65 @@
+#include <scope_exit/deadline_guard.hpp>
+
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+// Arm/cancel pairs per second: scope(deadline) against the raw wheel and, on Linux, an armed-then-disarmed timerfd.
+
+using namespace std::chrono_literals;
+using scope_exit_v1::timer_wheel;
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+
+    auto & wheel = timer_wheel::local();
+
+    bench::report("timer_wheel arm/cancel", bench::ns_per_op(iterations, [&](std::size_t) {
+        timer_wheel::timer t;
+        t.fire = [](void *) {};
+        wheel.arm(t, timer_wheel::clock::now() + 10ms);
+        wheel.cancel(t);
+        bench::do_not_optimize(t);
+    }));
+
+    int fired = 0;
+    bench::report("scope(deadline)", bench::ns_per_op(iterations, [&](std::size_t) {
+        scope(deadline, 10ms) { ++fired; };
+    }));
+
+    // the same with 100k timers already pending in the wheel
+    std::vector<timer_wheel::timer> pending(100'000);
+    for (std::size_t i = 0; i != pending.size(); ++i)
+    {
+        pending[i].fire = [](void *) {};
+        wheel.arm(pending[i], timer_wheel::clock::now() + std::chrono::milliseconds{1 + i % 100'000});
+    }
+    bench::report("scope(deadline), 100k pending", bench::ns_per_op(iterations, [&](std::size_t) {
+        scope(deadline, 10ms) { ++fired; };
+    }));
+    for (auto & t : pending)
+    {
+        wheel.cancel(t);
+    }
+
+#if defined(__linux__)
+    int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    bench::report("timerfd arm/disarm (baseline)", bench::ns_per_op(iterations / 10, [&](std::size_t) {
+        itimerspec spec{};
+        spec.it_value.tv_nsec = 10'000'000;
+        ::timerfd_settime(fd, 0, &spec, nullptr);
+        spec.it_value.tv_nsec = 0;
+        ::timerfd_settime(fd, 0, &spec, nullptr);
+    }));
+    ::close(fd);
+#endif
+
+    bench::do_not_optimize(fired);
+}
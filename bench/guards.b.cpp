@@ -0,0 +1,288 @@
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/context.hpp>
+#include <scope_exit/deadline_guard.hpp>
+#include <scope_exit/latch.hpp>
+#include <scope_exit/lock_profiler.hpp>
+#include <scope_exit/parallel_region.hpp>
+#include <scope_exit/span.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <scope_exit/signal_mask.hpp>
+#include <scope_exit/timed.hpp>
+#endif
+
+#if defined(__linux__)
+#include <scope_exit/batched_notifier.hpp>
+#include <scope_exit/shared_segment.hpp>
+#include <scope_exit/streaming_reader.hpp>
+#endif
+
+#include "baseline.hpp"
+#include "bench.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Regression check for the guards: every flavor is timed in repeated trials on a pinned core and compared with the
+// baseline stored in the build tree by the Mann-Whitney U test.  A flavor regresses when the difference is
+// significant and its median is slower by more than the threshold.  Add new guard flavors to run_all().
+//
+// usage: bench_guards [--save] [--baseline file] [--trials n] [--threshold percent] [--cpu n]
+//   --save       store this run as the baseline (done anyway when there is none yet)
+//   exit status  1 if any flavor regressed
+
+#if !defined(SCOPE_EXIT_BENCH_BASELINE)
+#define SCOPE_EXIT_BENCH_BASELINE "guards.baseline.json"
+#endif
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr double significance = 0.01;
+
+struct request_id
+{
+    std::size_t value;
+};
+
+struct harness
+{
+    bench::trial_options options;
+    bench::results baseline;
+    bench::results current;
+    double threshold = 0.10;
+    int regressions = 0;
+
+    template <typename Op>
+    void measure(char const * name, Op && op)
+    {
+        auto samples = bench::trials(op, options);
+        double const now = bench::median(samples);
+        std::printf("%-40s %10.2f ns/op", name, now);
+
+        auto found = baseline.find(name);
+        if (found != baseline.end())
+        {
+            double const before = bench::median(found->second);
+            double const change = before > 0 ? now / before - 1 : 0.0;
+            double const p = bench::mann_whitney_p(found->second, samples);
+            char const * verdict = "same";
+            if (p < significance && change > threshold)
+            {
+                verdict = "REGRESSION";
+                ++regressions;
+            }
+            else if (p < significance && change < -threshold)
+            {
+                verdict = "faster";
+            }
+            std::printf("  baseline %10.2f ns/op %+7.1f%%  p=%.4f  %s", before, 100 * change, p, verdict);
+        }
+        std::printf("\n");
+        current[name] = std::move(samples);
+    }
+};
+
+void run_all(harness & h)
+{
+    h.measure("scope(exit)", [](std::size_t) {
+        int x = 0;
+        scope(exit) { ++x; };
+        bench::do_not_optimize(x);
+    });
+    h.measure("scope(success)", [](std::size_t) {
+        int x = 0;
+        scope(success) { ++x; };
+        bench::do_not_optimize(x);
+    });
+    h.measure("scope(failure)", [](std::size_t) {
+        int x = 0;
+        scope(failure) { ++x; };
+        bench::do_not_optimize(x);
+    });
+
+    // leaving by an exception: the cost is the unwinding, the guards must not add to it
+    h.measure("scope(exit), unwinding", [](std::size_t) {
+        int x = 0;
+        try
+        {
+            scope(exit) { ++x; };
+            throw 1;
+        }
+        catch (int)
+        {
+        }
+        bench::do_not_optimize(x);
+    });
+    h.measure("scope(success), unwinding", [](std::size_t) {
+        int x = 0;
+        try
+        {
+            scope(success) { ++x; };
+            throw 1;
+        }
+        catch (int)
+        {
+        }
+        bench::do_not_optimize(x);
+    });
+    h.measure("scope(failure), unwinding", [](std::size_t) {
+        int x = 0;
+        try
+        {
+            scope(failure) { ++x; };
+            throw 1;
+        }
+        catch (int)
+        {
+        }
+        bench::do_not_optimize(x);
+    });
+
+    h.measure("scope(deadline)", [](std::size_t) {
+        int fired = 0;
+        scope(deadline, 10ms) { ++fired; };
+        bench::do_not_optimize(fired);
+    });
+
+    static std::mutex mutex;
+    h.measure("scope(locked)", [](std::size_t) {
+        scope(locked, mutex);
+    });
+
+    // drained as it goes, so the spans are queued rather than dropped
+    h.measure("scope(span)", [](std::size_t i) {
+        {
+            scope(span, "guards");
+        }
+        if (i % 256 == 255)
+        {
+            scope_exit_v1::span_exporter::global().drain([](scope_exit_v1::span_record const &) {});
+        }
+    });
+    h.measure("scope(context)", [](std::size_t i) {
+        scope(context, request_id, i);
+        bench::do_not_optimize(scope_exit_v1::current_context<request_id>());
+    });
+    h.measure("scope(parallel_region)", [](std::size_t) {
+        scope(parallel_region, 4);
+    });
+
+    static scope_exit_v1::completion_latch latch{std::size_t{1} << 60, 1};
+    h.measure("scope(count_down)", [](std::size_t) {
+        scope(count_down, latch);
+    });
+
+#if defined(__unix__) || defined(__APPLE__)
+    h.measure("scope(signals_blocked)", [](std::size_t) {
+        scope(signals_blocked, SIGINT, SIGTERM);
+    });
+    h.measure("scope(timed)", [](std::size_t) {
+        scope(timed);
+    });
+#endif
+
+#if defined(__linux__)
+    if (std::FILE * file = std::tmpfile())
+    {
+        h.measure("scope(streaming)", [fd = fileno(file)](std::size_t) {
+            scope(streaming, fd);
+        });
+        std::fclose(file);
+    }
+
+    // sealing needs a segment that is not sealed yet, so this includes creating one
+    h.measure("shared_segment + scope(sealed)", [](std::size_t) {
+        scope_exit_v1::shared_segment segment{std::size_t{4096}};
+        scope(sealed, segment);
+        static_cast<char *>(segment.data())[0] = 1;
+    });
+
+    static scope_exit_v1::batched_notifier notifier;
+    h.measure("scope(notify_batch)", [](std::size_t i) {
+        {
+            scope(notify_batch, notifier);
+            notifier.notify();
+            notifier.notify();
+        }
+        if (i % 256 == 255)
+        {
+            notifier.consume();
+        }
+    });
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    harness h;
+    char const * path = SCOPE_EXIT_BENCH_BASELINE;
+    bool save = false;
+    int cpu = -1;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool const has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--save") == 0)
+        {
+            save = true;
+        }
+        else if (std::strcmp(argv[i], "--baseline") == 0 && has_value)
+        {
+            path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--trials") == 0 && has_value)
+        {
+            h.options.trials = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && has_value)
+        {
+            h.threshold = std::strtod(argv[++i], nullptr) / 100;
+        }
+        else if (std::strcmp(argv[i], "--cpu") == 0 && has_value)
+        {
+            cpu = std::atoi(argv[++i]);
+        }
+        else
+        {
+            std::fprintf(stderr,
+                         "usage: %s [--save] [--baseline file] [--trials n] [--threshold percent] [--cpu n]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    if (!bench::pin_to_cpu(cpu))
+    {
+        std::fprintf(stderr, "warning: could not pin to a CPU, expect more noise\n");
+    }
+    h.baseline = bench::load_baseline(path);
+    std::printf("%u trials of %lld ms per flavor, baseline %s%s\n", h.options.trials,
+                static_cast<long long>(h.options.trial_time.count()), path,
+                h.baseline.empty() ? " (none yet)" : "");
+
+    run_all(h);
+
+    if (save || h.baseline.empty())
+    {
+        if (!bench::save_baseline(path, h.current))
+        {
+            std::fprintf(stderr, "cannot write %s\n", path);
+            return 2;
+        }
+        std::printf("saved baseline %s\n", path);
+    }
+    if (h.regressions != 0)
+    {
+        std::printf("%d regression(s)\n", h.regressions);
+        return 1;
+    }
+}
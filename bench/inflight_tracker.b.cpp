@@ -0,0 +1,43 @@
+#include <scope_exit/inflight_tracker.hpp>
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Enter/leave throughput as threads are added: inflight_tracker against one shared atomic counter decremented with
+// scope(exit), plus the time to drain once the threads have stopped.
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::atomic<std::int64_t> inflight{0};
+        std::snprintf(name, sizeof name, "shared atomic t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+            ++inflight;
+            scope(exit) { --inflight; };
+        }));
+
+        scope_exit_v1::inflight_tracker tracker;
+        std::snprintf(name, sizeof name, "inflight_tracker t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+            auto admitted = tracker.enter();
+            bench::do_not_optimize(admitted);
+        }));
+    }
+
+    scope_exit_v1::inflight_tracker tracker;
+    bench::report("drain with nothing in flight", bench::ns_per_op(iterations, [&](std::size_t) {
+                      tracker.drain();
+                      tracker.reopen();
+                  }));
+}
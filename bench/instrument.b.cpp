@@ -0,0 +1,43 @@
+#define SCOPE_EXIT_INSTRUMENT
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Cost of the per-site probe that SCOPE_EXIT_INSTRUMENT adds to scope(exit): a bare guard (built without the macro)
+// against an instrumented one that updates the high-water mark on every entry or on every 16th, on one thread and
+// with several threads entering the same site.
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::snprintf(name, sizeof name, "scope(exit) bare t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [] {
+            int x = 0;
+            [[maybe_unused]] auto const & g = scope_exit_v1::detail::scope_guard_tag{} + [&] { ++x; };
+            bench::do_not_optimize(x);
+        }));
+
+        for (std::uint32_t period : {1u, 16u})
+        {
+            scope_exit_v1::instrument::set_sample_period(period);
+            std::snprintf(name, sizeof name, "scope(exit) instrumented t=%u sample=1/%u", threads, period);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [] {
+                int x = 0;
+                scope(exit) { ++x; };
+                bench::do_not_optimize(x);
+            }));
+        }
+    }
+
+    scope_exit_v1::instrument::report(stdout);
+}
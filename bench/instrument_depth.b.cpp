@@ -0,0 +1,48 @@
+#define SCOPE_EXIT_INSTRUMENT_DEPTH
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Cost of depth tracking on top of the SCOPE_EXIT_INSTRUMENT probe: instrument.b.cpp measures the plain probe, this
+// one the probe with SCOPE_EXIT_INSTRUMENT_DEPTH, for a single guard and for a guard nested four deep in recursion.
+
+namespace
+{
+
+int nested(int depth)
+{
+    int x = depth;
+    scope(exit) { bench::do_not_optimize(x); };
+    return depth == 1 ? x : nested(depth - 1) + x;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::snprintf(name, sizeof name, "scope(exit) depth t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [] {
+            int x = 0;
+            scope(exit) { ++x; };
+            bench::do_not_optimize(x);
+        }));
+
+        std::snprintf(name, sizeof name, "scope(exit) depth 4 nested, per guard t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations / 4, [] {
+            bench::do_not_optimize(nested(4));
+        }) / 4);
+    }
+
+    scope_exit_v1::instrument::report(stdout);
+}
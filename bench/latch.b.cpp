@@ -0,0 +1,77 @@
+#include <scope_exit/latch.hpp>
+
+#include "bench.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#if __has_include(<latch>)
+#include <latch>
+#endif
+
+// Fan-out completion: `threads` workers each finish `tasks / threads` subtasks that count down one latch, and the
+// main thread waits for all of them.  Reports the wall time per subtask from the start signal until wait() returns,
+// for completion_latch with and without scope(count_down), and std::latch (C++20).
+
+namespace
+{
+
+template <typename Latch, typename Task>
+double fan_out(unsigned threads, std::size_t tasks, Latch & latch, Task task)
+{
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        workers.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i != tasks / threads; ++i)
+            {
+                task();
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    latch.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto & w : workers)
+    {
+        w.join();
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(tasks / threads * threads);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4'000'000;
+    char name[64];
+
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        scope_exit_v1::completion_latch latch{tasks / threads * threads};
+        std::snprintf(name, sizeof name, "completion_latch t=%u", threads);
+        bench::report(name, fan_out(threads, tasks, latch, [&] { scope(count_down, latch); }));
+
+        scope_exit_v1::completion_latch bare{tasks / threads * threads};
+        std::snprintf(name, sizeof name, "completion_latch count_down() t=%u", threads);
+        bench::report(name, fan_out(threads, tasks, bare, [&] { bare.count_down(); }));
+
+#if defined(__cpp_lib_latch)
+        std::latch std_latch{static_cast<std::ptrdiff_t>(tasks / threads * threads)};
+        std::snprintf(name, sizeof name, "std::latch t=%u", threads);
+        bench::report(name, fan_out(threads, tasks, std_latch, [&] { std_latch.count_down(); }));
+#endif
+    }
+}
@@ -0,0 +1,40 @@
+#include <scope_exit/lock_profiler.hpp>
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+// Cost of scope(locked) against std::lock_guard around a tiny critical section, uncontended on one thread and
+// contended on several.
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::mutex m;
+        long counter = 0;
+
+        std::snprintf(name, sizeof name, "std::lock_guard t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+            std::lock_guard<std::mutex> lock{m};
+            ++counter;
+        }));
+
+        std::snprintf(name, sizeof name, "scope(locked) t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+            scope(locked, m);
+            ++counter;
+        }));
+        bench::do_not_optimize(counter);
+    }
+
+    scope_exit_v1::lock_profile::report(stdout);
+}
@@ -0,0 +1,90 @@
+#include <scope_exit/memo_cache.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Per-lookup latency and hit rate for request-scoped memoization: recomputing every time, a per-request
+// std::unordered_map, and memo_scope.  Each request performs `lookups` lookups over a skewed key set.
+
+namespace
+{
+
+std::uint64_t expensive(std::uint64_t key)
+{
+    // stands in for a lookup worth caching (~100ns)
+    std::uint64_t h = key;
+    for (int i = 0; i != 64; ++i)
+    {
+        h = (h ^ (h >> 31)) * 0x9e3779b97f4a7c15ULL + static_cast<std::uint64_t>(i);
+    }
+    return h;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000;
+    std::size_t const lookups = 256;
+    char name[96];
+
+    for (std::uint64_t distinct : {16, 128, 1024})
+    {
+        // skewed keys: squaring a uniform variate favors small keys
+        std::mt19937_64 rng{42};
+        std::uniform_real_distribution<double> uniform{0.0, 1.0};
+        std::vector<std::uint64_t> keys(lookups);
+        for (auto & k : keys)
+        {
+            double u = uniform(rng);
+            k = static_cast<std::uint64_t>(u * u * static_cast<double>(distinct));
+        }
+
+        std::uint64_t sink = 0;
+        double per_lookup = static_cast<double>(lookups);
+
+        std::snprintf(name, sizeof name, "recompute, %llu keys", static_cast<unsigned long long>(distinct));
+        bench::report(name, bench::ns_per_op(requests, [&](std::size_t) {
+            for (auto k : keys)
+            {
+                sink += expensive(k);
+            }
+        }) / per_lookup);
+
+        std::snprintf(name, sizeof name, "unordered_map per request, %llu keys",
+                      static_cast<unsigned long long>(distinct));
+        bench::report(name, bench::ns_per_op(requests, [&](std::size_t) {
+            std::unordered_map<std::uint64_t, std::uint64_t> cache;
+            for (auto k : keys)
+            {
+                auto it = cache.find(k);
+                if (it == cache.end())
+                {
+                    it = cache.emplace(k, expensive(k)).first;
+                }
+                sink += it->second;
+            }
+        }) / per_lookup);
+
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::snprintf(name, sizeof name, "memo_scope, %llu keys", static_cast<unsigned long long>(distinct));
+        bench::report(name, bench::ns_per_op(requests, [&](std::size_t) {
+            scope_exit_v1::memo_scope<std::uint64_t, std::uint64_t> memo;
+            for (auto k : keys)
+            {
+                sink += scope_exit_v1::memoize<std::uint64_t, std::uint64_t>(k, expensive);
+            }
+            hits += memo.hits();
+            misses += memo.misses();
+        }) / per_lookup);
+        std::printf("    hit rate %.1f%%\n", 100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses));
+
+        bench::do_not_optimize(sink);
+    }
+}
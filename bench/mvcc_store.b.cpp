@@ -0,0 +1,89 @@
+#include <scope_exit/mvcc_store.hpp>
+
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+// Read and write scaling: mvcc_store read/write scopes against an unordered_map behind a std::shared_mutex.  Every
+// read looks up two keys in one snapshot; every write updates two keys atomically.
+
+namespace
+{
+
+constexpr std::uint64_t keys = 1024;
+
+struct locked_map
+{
+    std::shared_mutex mutex;
+    std::unordered_map<std::uint64_t, std::uint64_t> map;
+};
+
+thread_local std::uint64_t rng = 0x9e3779b97f4a7c15ULL;
+
+std::uint64_t next_key()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng % keys;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    scope_exit_v1::mvcc_store<std::uint64_t, std::uint64_t> store;
+    locked_map locked;
+    {
+        decltype(store)::write_scope tx{store};
+        for (std::uint64_t k = 0; k != keys; ++k)
+        {
+            tx.put(k, k);
+            locked.map[k] = k;
+        }
+    }
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::snprintf(name, sizeof name, "mvcc read_scope, 2 lookups t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                          decltype(store)::read_scope snapshot{store};
+                          bench::do_not_optimize(snapshot.find(next_key()));
+                          bench::do_not_optimize(snapshot.find(next_key()));
+                      }));
+
+        std::snprintf(name, sizeof name, "shared_mutex read, 2 lookups t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                          std::shared_lock<std::shared_mutex> lock{locked.mutex};
+                          bench::do_not_optimize(locked.map.find(next_key()));
+                          bench::do_not_optimize(locked.map.find(next_key()));
+                      }));
+    }
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::snprintf(name, sizeof name, "mvcc write_scope, 2 keys t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations / 10, [&] {
+                          decltype(store)::write_scope tx{store};
+                          tx.put(next_key(), 1);
+                          tx.put(next_key(), 2);
+                      }));
+
+        std::snprintf(name, sizeof name, "shared_mutex write, 2 keys t=%u", threads);
+        bench::report(name, bench::parallel_ns_per_op(threads, iterations / 10, [&] {
+                          std::unique_lock<std::shared_mutex> lock{locked.mutex};
+                          locked.map[next_key()] = 1;
+                          locked.map[next_key()] = 2;
+                      }));
+    }
+}
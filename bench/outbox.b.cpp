@@ -0,0 +1,100 @@
+#include <scope_exit/outbox.hpp>
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Events per second for handlers that emit a few events each: per-event publishing (directly, and from a vector in
+// scope(success)) against an outbox publishing one batch.  A consumer thread drains the channel throughout.
+
+namespace
+{
+
+struct event
+{
+    std::uint64_t id = 0;
+    std::uint64_t payload[3] = {};
+};
+
+constexpr std::size_t events_per_handler = 8;
+
+template <typename Handler>
+double run(scope_exit_v1::event_channel<event> & channel, std::size_t handlers, Handler && handler)
+{
+    std::atomic<bool> done{false};
+    std::thread consumer{[&] {
+        while (!done.load(std::memory_order_relaxed))
+        {
+            channel.drain([](event const & e) { bench::do_not_optimize(e.id); });
+            std::this_thread::sleep_for(std::chrono::microseconds{50});
+        }
+    }};
+
+    double ns = bench::ns_per_op(handlers, handler);
+    done.store(true);
+    consumer.join();
+    channel.drain([](event const &) {});
+    return ns / events_per_handler;
+}
+
+void publish(scope_exit_v1::event_channel<event> & channel, event const & e)
+{
+    while (!channel.try_publish(e))
+    {
+        std::this_thread::yield();
+    }
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const handlers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500'000;
+    scope_exit_v1::event_channel<event> channel{1 << 16};
+
+    bench::report("per-event publish (not transactional)", run(channel, handlers, [&](std::size_t i) {
+                      for (std::size_t j = 0; j != events_per_handler; ++j)
+                      {
+                          publish(channel, event{i + j, {}});
+                      }
+                  }));
+
+    bench::report("vector + per-event publish in scope(success)", run(channel, handlers, [&](std::size_t i) {
+                      std::vector<event> pending;
+                      scope(success)
+                      {
+                          for (auto const & e : pending)
+                          {
+                              publish(channel, e);
+                          }
+                      };
+                      for (std::size_t j = 0; j != events_per_handler; ++j)
+                      {
+                          pending.push_back(event{i + j, {}});
+                      }
+                  }));
+
+    bench::report("outbox, one batch per handler", run(channel, handlers, [&](std::size_t i) {
+                      scope_exit_v1::outbox<event> box{channel};
+                      for (std::size_t j = 0; j != events_per_handler; ++j)
+                      {
+                          box.emit(event{i + j, {}});
+                      }
+                  }));
+
+    bench::report("outbox, nested merge per handler", run(channel, handlers, [&](std::size_t i) {
+                      scope_exit_v1::outbox<event> box{channel};
+                      for (std::size_t j = 0; j != events_per_handler; j += 2)
+                      {
+                          scope_exit_v1::outbox<event> step{channel};
+                          step.emit(event{i + j, {}});
+                          step.emit(event{i + j + 1, {}});
+                      }
+                  }));
+}
@@ -0,0 +1,90 @@
+#include <scope_exit/parallel_region.hpp>
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// A parallel loop whose body calls a library that is parallel itself.  The oblivious version starts one thread per
+// core at both levels; parallel_for hands the inner loops what is left of the outer region's budget.  Reports the
+// time per outer item and the peak number of threads running inner work at once.
+
+namespace
+{
+
+std::atomic<unsigned> active{0};
+std::atomic<unsigned> peak{0};
+
+void work(std::size_t i)
+{
+    auto now = ++active;
+    auto seen = peak.load(std::memory_order_relaxed);
+    while (now > seen && !peak.compare_exchange_weak(seen, now))
+    {
+    }
+
+    double x = static_cast<double>(i);
+    for (int k = 0; k != 200; ++k)
+    {
+        x = std::sqrt(x + k);
+    }
+    bench::do_not_optimize(x);
+    --active;
+}
+
+template <typename Body>
+void oblivious_parallel_for(unsigned threads, std::size_t n, Body body)
+{
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([=] {
+            for (std::size_t i = n * t / threads; i != n * (t + 1) / threads; ++i)
+            {
+                body(i);
+            }
+        });
+    }
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const outer = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    std::size_t const inner = 4096;
+    unsigned const cores = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    std::snprintf(name, sizeof name, "oblivious nested, %u threads per level", cores);
+    double ns = bench::ns_per_op(1, [&](std::size_t) {
+                    oblivious_parallel_for(cores, outer, [&](std::size_t) {
+                        oblivious_parallel_for(cores, inner, work);
+                    });
+                }) /
+                static_cast<double>(outer);
+    bench::report(name, ns);
+    std::printf("%-48s %12u threads\n", "  peak concurrency", peak.load());
+
+    peak = 0;
+    scope_exit_v1::thread_pool pool{cores - 1};
+    std::snprintf(name, sizeof name, "parallel_for nested, budget %u", cores);
+    ns = bench::ns_per_op(1, [&](std::size_t) {
+             scope(parallel_region, cores);
+             scope_exit_v1::parallel_for(pool, 0, outer, [&](std::size_t) {
+                 scope_exit_v1::parallel_for(pool, 0, inner, work);
+             });
+         }) /
+         static_cast<double>(outer);
+    bench::report(name, ns);
+    std::printf("%-48s %12u threads\n", "  peak concurrency", peak.load());
+}
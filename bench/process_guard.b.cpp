@@ -0,0 +1,32 @@
+#include <scope_exit/process_guard.hpp>
+
+#include "bench.hpp"
+
+#include <cstdlib>
+
+#include <sys/wait.h>
+
+// Spawn + reap throughput: one guard per child, one group guard per batch, and plain waitpid as the baseline.
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    std::size_t const batch = 32;
+
+    bench::report("waitpid (baseline)", bench::ns_per_op(iterations, [](std::size_t) {
+        pid_t pid = scope_exit_v1::detail::spawn_process({"/bin/true"});
+        ::waitpid(pid, nullptr, 0);
+    }));
+
+    bench::report("process_guard", bench::ns_per_op(iterations, [](std::size_t) {
+        auto child = scope_exit_v1::process_guard::spawn({"/bin/true"});
+    }));
+
+    bench::report("process_group_guard (per child)", bench::ns_per_op(iterations / batch, [&](std::size_t) {
+        scope_exit_v1::process_group_guard group;
+        for (std::size_t i = 0; i != batch; ++i)
+        {
+            group.spawn({"/bin/true"});
+        }
+    }) / batch);
+}
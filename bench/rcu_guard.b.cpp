@@ -0,0 +1,98 @@
+#include <scope_exit/rcu_guard.hpp>
+
+#include "bench.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Read throughput of a configuration object that a background thread replaces every 100us: rcu_cell::read()
+// against std::atomic_load of a std::shared_ptr (std::atomic<std::shared_ptr> from C++20 on).
+
+namespace
+{
+
+struct config
+{
+    int version = 0;
+    int limits[15] = {};
+    std::string name = "default";
+};
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_atomic_shared_ptr)
+using shared_config = std::atomic<std::shared_ptr<config const>>;
+
+std::shared_ptr<config const> load(shared_config & p) { return p.load(); }
+void store(shared_config & p, std::shared_ptr<config const> c) { p.store(std::move(c)); }
+#else
+using shared_config = std::shared_ptr<config const>;
+
+std::shared_ptr<config const> load(shared_config & p) { return std::atomic_load(&p); }
+void store(shared_config & p, std::shared_ptr<config const> c) { std::atomic_store(&p, std::move(c)); }
+#endif
+
+template <typename Update>
+struct background_writer
+{
+    explicit background_writer(Update update)
+        : thread{[this, update] {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                update();
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+            }
+        }}
+    {}
+
+    ~background_writer()
+    {
+        done.store(true);
+        thread.join();
+    }
+
+    std::atomic<bool> done{false};
+    std::thread thread;
+};
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    scope_exit_v1::rcu_cell<config> cell;
+    shared_config shared{std::make_shared<config const>()};
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        {
+            background_writer writer{[&] {
+                auto draft = cell.update();
+                draft->version += 1;
+            }};
+            std::snprintf(name, sizeof name, "rcu_cell::read t=%u", threads);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                              auto cfg = cell.read();
+                              bench::do_not_optimize(cfg->limits[3]);
+                          }));
+        }
+        {
+            background_writer writer{[&] {
+                auto next = std::make_shared<config>(*load(shared));
+                next->version += 1;
+                store(shared, std::move(next));
+            }};
+            std::snprintf(name, sizeof name, "atomic shared_ptr load t=%u", threads);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                              auto cfg = load(shared);
+                              bench::do_not_optimize(cfg->limits[3]);
+                          }));
+        }
+    }
+}
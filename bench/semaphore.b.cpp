@@ -0,0 +1,49 @@
+#include <scope_exit/semaphore.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#if __has_include(<semaphore>)
+#include <semaphore>
+#endif
+
+// Acquire/release throughput under contention: admission_semaphore against std::counting_semaphore (C++20).
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    char name[64];
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (std::int32_t permits : {1, 4})
+        {
+            scope_exit_v1::admission_semaphore sem{permits};
+            std::snprintf(name, sizeof name, "admission_semaphore t=%u permits=%d", threads, permits);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                auto permit = sem.acquire();
+                bench::do_not_optimize(permit);
+            }));
+
+            scope_exit_v1::admission_semaphore adaptive{permits, {permits, permits, 1, 0.5}};
+            std::snprintf(name, sizeof name, "admission_semaphore aimd t=%u permits=%d", threads, permits);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                auto permit = adaptive.acquire();
+                bench::do_not_optimize(permit);
+            }));
+
+#if defined(__cpp_lib_semaphore)
+            std::counting_semaphore<> std_sem{permits};
+            std::snprintf(name, sizeof name, "std::counting_semaphore t=%u permits=%d", threads, permits);
+            bench::report(name, bench::parallel_ns_per_op(threads, iterations, [&] {
+                std_sem.acquire();
+                std_sem.release();
+            }));
+#endif
+        }
+    }
+}
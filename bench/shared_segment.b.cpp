@@ -0,0 +1,231 @@
+#include <scope_exit/shared_segment.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Handing messages to a child process: copied through a pipe, or written into a sealed memfd segment whose
+// descriptor is passed with SCM_RIGHTS (a segment per message, as when the consumer keeps them).  The producer
+// fills each message; the consumer either sums all of it or only reads the first cache line, as a router looking
+// at a header would.  Through the pipe every byte is copied twice regardless; a fresh segment costs a page fault per
+// page on each side instead.  Where faults are expensive, as on virtual machines, that loses to the copy unless the
+// segment sits on huge pages (the last column; it falls back to normal pages unless vm.nr_hugepages reserves some),
+// and hugetlb segments are rounded up to a whole huge page, which small messages pay for.
+//
+// usage: bench_shared_segment [total MiB]   (default 512)
+
+namespace
+{
+
+using message_fn = void (*)(int channel, std::size_t size, std::size_t count);
+
+bool header_only = false;
+auto backing = scope_exit_v1::shared_segment::pages::normal;
+
+std::uint64_t sum(void const * data, std::size_t size)
+{
+    auto const * words = static_cast<std::uint64_t const *>(data);
+    std::size_t const n = header_only ? 64 / sizeof(std::uint64_t) : size / sizeof(std::uint64_t);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i != n; ++i)
+    {
+        total += words[i];
+    }
+    return total;
+}
+
+bool send_all(int fd, void const * data, std::size_t size)
+{
+    auto const * bytes = static_cast<char const *>(data);
+    while (size != 0)
+    {
+        ssize_t n = ::write(fd, bytes, size);
+        if (n <= 0)
+        {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool receive_all(int fd, void * data, std::size_t size)
+{
+    auto * bytes = static_cast<char *>(data);
+    while (size != 0)
+    {
+        ssize_t n = ::read(fd, bytes, size);
+        if (n <= 0)
+        {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void send_fd(int socket, int fd)
+{
+    char byte = 0;
+    iovec io{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof control;
+    cmsghdr * header = CMSG_FIRSTHDR(&message);
+    if (header == nullptr)
+    {
+        std::exit(1);
+    }
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+    if (::sendmsg(socket, &message, 0) != 1)
+    {
+        std::perror("sendmsg");
+        std::exit(1);
+    }
+}
+
+int receive_fd(int socket)
+{
+    char byte = 0;
+    iovec io{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof control;
+    cmsghdr * header = nullptr;
+    if (::recvmsg(socket, &message, 0) != 1 || (header = CMSG_FIRSTHDR(&message)) == nullptr)
+    {
+        return -1;
+    }
+    int fd = -1;
+    std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+    return fd;
+}
+
+void pipe_producer(int channel, std::size_t size, std::size_t count)
+{
+    std::vector<char> message(size);
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        std::memset(message.data(), static_cast<int>(i), size);
+        send_all(channel, message.data(), size);
+    }
+}
+
+void pipe_consumer(int channel, std::size_t size, std::size_t count)
+{
+    std::vector<char> message(size);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i != count && receive_all(channel, message.data(), size); ++i)
+    {
+        total += sum(message.data(), size);
+    }
+    send_all(channel, &total, sizeof total);
+}
+
+void segment_producer(int channel, std::size_t size, std::size_t count)
+{
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        scope_exit_v1::shared_segment segment{size, backing};
+        {
+            scope(sealed, segment);
+            std::memset(segment.data(), static_cast<int>(i), size);
+        }
+        send_fd(channel, segment.fd());
+    }
+}
+
+void segment_consumer(int channel, std::size_t size, std::size_t count)
+{
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        int fd = receive_fd(channel);
+        if (fd < 0)
+        {
+            break;
+        }
+        auto segment = scope_exit_v1::shared_segment::attach(fd);
+        if (!segment.sealed() || segment.size() < size)
+        {
+            break;
+        }
+        total += sum(segment.data(), size);
+    }
+    send_all(channel, &total, sizeof total);
+}
+
+// MiB/s from the first message produced to the consumer's reply
+double transfer(message_fn producer, message_fn consumer, std::size_t size, std::size_t count)
+{
+    int channel[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, channel) != 0)
+    {
+        std::perror("socketpair");
+        std::exit(1);
+    }
+    pid_t const pid = ::fork();
+    if (pid == 0)
+    {
+        ::close(channel[0]);
+        consumer(channel[1], size, count);
+        ::_exit(0);
+    }
+    ::close(channel[1]);
+
+    auto start = std::chrono::steady_clock::now();
+    producer(channel[0], size, count);
+    std::uint64_t total = 0;
+    receive_all(channel[0], &total, sizeof total);
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ::close(channel[0]);
+    ::waitpid(pid, nullptr, 0);
+    return static_cast<double>(size * count) / (1024.0 * 1024.0) / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const total = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512) << 20;
+
+    using pages = scope_exit_v1::shared_segment::pages;
+    bool const huge = scope_exit_v1::shared_segment{1, pages::huge}.huge_pages();
+
+    std::printf("%-14s %12s %16s %16s %16s\n", "consumer", "message", "pipe MiB/s", "memfd MiB/s",
+                huge ? "hugetlb MiB/s" : "(no hugetlb)");
+    for (bool header : {false, true})
+    {
+        header_only = header;
+        for (std::size_t size : {std::size_t{64} << 10, std::size_t{1} << 20, std::size_t{16} << 20})
+        {
+            std::size_t const count = total / size;
+            double const copied = transfer(pipe_producer, pipe_consumer, size, count);
+            backing = pages::normal;
+            double const shared = transfer(segment_producer, segment_consumer, size, count);
+            backing = pages::huge;
+            double const shared_huge = transfer(segment_producer, segment_consumer, size, count);
+            std::printf("%-14s %8zu KiB %16.1f %16.1f %16.1f\n", header ? "reads header" : "reads all", size >> 10,
+                        copied, shared, shared_huge);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <scope_exit/signal_mask.hpp>
+
+#include "bench.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#include <pthread.h>
+
+// Critical sections per second, and the pthread_sigmask calls they cost: pthread_sigmask in scope(exit) against the
+// cached signal_block_guard, for a section nested three deep.
+
+namespace
+{
+
+std::size_t raw_syscalls = 0;
+
+void raw_section(sigset_t const & set, int depth)
+{
+    sigset_t old;
+    ::pthread_sigmask(SIG_BLOCK, &set, &old);
+    ++raw_syscalls;
+    scope(exit)
+    {
+        ::pthread_sigmask(SIG_SETMASK, &old, nullptr);
+        ++raw_syscalls;
+    };
+    if (depth > 1)
+    {
+        raw_section(set, depth - 1);
+    }
+}
+
+void cached_section(int depth)
+{
+    scope(signals_blocked, SIGINT, SIGTERM);
+    if (depth > 1)
+    {
+        cached_section(depth - 1);
+    }
+}
+
+void print_syscalls(std::size_t syscalls, std::size_t iterations, double ns)
+{
+    double per_section = static_cast<double>(syscalls) / static_cast<double>(iterations);
+    std::printf("%-48s %12.1f syscalls/op %9.0f syscalls/s\n", "", per_section, ns > 0 ? per_section * 1e9 / ns : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500'000;
+    int const depth = 3;
+
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+
+    double ns = bench::ns_per_op(iterations, [&](std::size_t) { raw_section(set, depth); });
+    bench::report("pthread_sigmask + scope(exit), 3 nested", ns);
+    print_syscalls(raw_syscalls, iterations, ns);
+
+    auto & mask = scope_exit_v1::signal_mask::local();
+    mask.refresh();
+    auto before = mask.syscalls();
+    ns = bench::ns_per_op(iterations, [&](std::size_t) { cached_section(depth); });
+    bench::report("scope(signals_blocked), 3 nested", ns);
+    print_syscalls(mask.syscalls() - before, iterations, ns);
+
+    // the steady state inside an already blocked region: no syscalls at all
+    scope(signals_blocked, SIGINT, SIGTERM);
+    before = mask.syscalls();
+    ns = bench::ns_per_op(iterations, [&](std::size_t) { cached_section(depth); });
+    bench::report("scope(signals_blocked), already blocked", ns);
+    print_syscalls(mask.syscalls() - before, iterations, ns);
+}
@@ -0,0 +1,84 @@
+#include <scope_exit/span.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Spans per second: scope(span) with a background exporter against an allocating RAII span pushed into a
+// mutex-protected vector.
+
+namespace
+{
+
+struct heap_span
+{
+    std::string name;
+    std::int64_t start_ns;
+    std::int64_t end_ns;
+};
+
+std::mutex heap_spans_mutex;
+std::vector<std::unique_ptr<heap_span>> heap_spans;
+
+struct allocating_span_guard
+{
+    explicit allocating_span_guard(char const * name)
+        : span{new heap_span{name, std::chrono::steady_clock::now().time_since_epoch().count(), 0}}
+    {}
+
+    ~allocating_span_guard()
+    {
+        span->end_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+        std::lock_guard<std::mutex> lock{heap_spans_mutex};
+        heap_spans.push_back(std::move(span));
+    }
+
+    std::unique_ptr<heap_span> span;
+};
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2'000'000;
+
+    std::atomic<bool> done{false};
+    std::size_t exported = 0;
+    std::thread consumer{[&] {
+        while (!done.load())
+        {
+            exported += scope_exit_v1::span_exporter::global().drain([](scope_exit_v1::span_record const &) {});
+            std::this_thread::sleep_for(std::chrono::microseconds{200});
+        }
+    }};
+
+    bench::report("scope(span)", bench::ns_per_op(iterations, [](std::size_t) {
+        scope(span, "request");
+    }));
+
+    bench::report("scope(span), nested x4 (per span)", bench::ns_per_op(iterations / 4, [](std::size_t) {
+        scope(span, "a");
+        scope(span, "b");
+        scope(span, "c");
+        scope(span, "d");
+    }) / 4);
+
+    done = true;
+    consumer.join();
+    std::printf("exported %zu spans, dropped %zu\n", exported, scope_exit_v1::span_exporter::global().dropped());
+
+    bench::report("allocating span (baseline)", bench::ns_per_op(iterations, [](std::size_t i) {
+        allocating_span_guard g{"request"};
+        if (i % 4096 == 0)
+        {
+            std::lock_guard<std::mutex> lock{heap_spans_mutex};
+            heap_spans.clear();
+        }
+    }));
+}
@@ -0,0 +1,190 @@
+#include <scope_exit/scope_exit.hpp>
+
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+// Stack frame size of a recursive tree walker with 0 to 16 guards of each kind, the guards either capturing two locals
+// or calling a function without captures.  Two measurements per walker:
+//   - the static frame size the compiler reports with -fstack-usage; bench/CMakeLists.txt adds the flag for GCC and
+//     Clang and passes the .su file it writes (or give its path as the first argument)
+//   - the runtime distance between the frame addresses of two consecutive recursion levels
+// plus the time per recursion level, since deeper frames also touch more cache lines.  Build it at each standard
+// (the release-cxx17/20/23 presets) to compare: from C++20 on, a guard without captures stores no closure.
+
+#if !defined(SCOPE_EXIT_STACK_USAGE)
+#define SCOPE_EXIT_STACK_USAGE "stack_frames.b.cpp.su"
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE        __attribute__((noinline))
+#define BENCH_FRAME_ADDRESS() reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0))
+#else
+#define BENCH_NOINLINE
+#define BENCH_FRAME_ADDRESS() reinterpret_cast<std::uintptr_t>(&depth)
+#endif
+
+namespace
+{
+
+constexpr int levels = 64;
+
+int sink;
+std::uintptr_t top_frame;
+std::uintptr_t bottom_frame;
+
+// opaque to the optimizer, and may throw as far as it knows, so every guard stays live across it
+BENCH_NOINLINE void visit(int & visited, int depth)
+{
+    sink += visited + depth;
+    if (sink == -1)
+    {
+        throw depth;
+    }
+}
+
+BENCH_NOINLINE void rollback()
+{
+    sink -= 1;
+    if (sink == -1)
+    {
+        throw 0;
+    }
+}
+
+void note_frame(int depth, std::uintptr_t frame)
+{
+    if (depth == levels)
+    {
+        top_frame = frame;
+    }
+    else if (depth == levels - 1)
+    {
+        bottom_frame = frame;
+    }
+}
+
+}  // namespace
+
+#define GUARD_captures(kind)  scope(kind) { visit(visited, depth); };
+#define GUARD_stateless(kind) scope(kind) { rollback(); };
+#define GUARDS_0(kind, style)
+#define GUARDS_1(kind, style)  GUARD_##style(kind)
+#define GUARDS_2(kind, style)  GUARDS_1(kind, style) GUARDS_1(kind, style)
+#define GUARDS_4(kind, style)  GUARDS_2(kind, style) GUARDS_2(kind, style)
+#define GUARDS_8(kind, style)  GUARDS_4(kind, style) GUARDS_4(kind, style)
+#define GUARDS_16(kind, style) GUARDS_8(kind, style) GUARDS_8(kind, style)
+
+#define WALKER_(kind, style, n)                                                                                        \
+    BENCH_NOINLINE int walk_##kind##_##style##_##n(int depth)                                                          \
+    {                                                                                                                  \
+        int visited = depth;                                                                                           \
+        GUARDS_##n(kind, style);                                                                                       \
+        note_frame(depth, BENCH_FRAME_ADDRESS());                                                                      \
+        visit(visited, depth);                                                                                         \
+        return depth == 0 ? visited : walk_##kind##_##style##_##n(depth - 1) + visited;                                \
+    }
+
+#define WALKERS_(kind, style)                                                                                          \
+    WALKER_(kind, style, 0) WALKER_(kind, style, 1) WALKER_(kind, style, 2) WALKER_(kind, style, 4)                    \
+        WALKER_(kind, style, 8) WALKER_(kind, style, 16)
+
+WALKERS_(exit, captures)
+WALKERS_(success, captures)
+WALKERS_(failure, captures)
+WALKERS_(exit, stateless)
+WALKERS_(success, stateless)
+WALKERS_(failure, stateless)
+
+namespace
+{
+
+struct walker
+{
+    char const * kind;
+    char const * style;
+    int guards;
+    char const * name;
+    int (*walk)(int);
+};
+
+#define WALKER_ENTRY_(kind, style, n)                                                                                  \
+    {#kind, #style, n, "walk_" #kind "_" #style "_" #n "(", &walk_##kind##_##style##_##n}
+#define WALKER_ENTRIES_(kind, style)                                                                                   \
+    WALKER_ENTRY_(kind, style, 0), WALKER_ENTRY_(kind, style, 1), WALKER_ENTRY_(kind, style, 2),                       \
+        WALKER_ENTRY_(kind, style, 4), WALKER_ENTRY_(kind, style, 8), WALKER_ENTRY_(kind, style, 16)
+
+walker const walkers[] = {WALKER_ENTRIES_(exit, captures),  WALKER_ENTRIES_(success, captures),
+                          WALKER_ENTRIES_(failure, captures), WALKER_ENTRIES_(exit, stateless),
+                          WALKER_ENTRIES_(success, stateless), WALKER_ENTRIES_(failure, stateless)};
+
+/// Frame sizes from a GCC or Clang .su file, keyed by the "file:line:column:function" location; one
+/// "location<TAB>bytes<TAB>qualifiers" line per function.
+std::map<std::string, long> read_stack_usage(char const * path)
+{
+    std::map<std::string, long> sizes;
+    std::FILE * in = std::fopen(path, "r");
+    if (in == nullptr)
+    {
+        return sizes;
+    }
+    char line[1024];
+    while (std::fgets(line, sizeof line, in) != nullptr)
+    {
+        char * tab = std::strchr(line, '\t');
+        if (tab == nullptr)
+        {
+            continue;
+        }
+        *tab = '\0';
+        sizes[line] = std::strtol(tab + 1, nullptr, 10);
+    }
+    std::fclose(in);
+    return sizes;
+}
+
+long static_frame(std::map<std::string, long> const & sizes, char const * prefix)
+{
+    for (auto const & [name, bytes] : sizes)
+    {
+        // the walker itself, not the lambdas of its guards
+        if (name.find(prefix) != std::string::npos && name.find("lambda") == std::string::npos)
+        {
+            return bytes;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    char const * path = argc > 1 ? argv[1] : SCOPE_EXIT_STACK_USAGE;
+    auto const sizes = read_stack_usage(path);
+
+    std::printf("C++ %ld", static_cast<long>(__cplusplus));
+#if defined(__VERSION__)
+    std::printf(", compiler %s", __VERSION__);
+#endif
+#if defined(__OPTIMIZE__)
+    std::printf(", optimized");
+#endif
+    std::printf("\nstack usage from %s%s\n\n", path, sizes.empty() ? " (not found)" : "");
+    std::printf("%-8s %-10s %6s %16s %16s %12s\n", "kind", "action", "guards", "-fstack-usage B", "runtime B/level",
+                "ns/level");
+
+    for (auto const & w : walkers)
+    {
+        w.walk(levels);
+        long const runtime = static_cast<long>(top_frame - bottom_frame);
+        double const ns = bench::ns_per_op(20'000, [&](std::size_t) { bench::do_not_optimize(w.walk(levels)); });
+        std::printf("%-8s %-10s %6d %16ld %16ld %12.2f\n", w.kind, w.style, w.guards, static_frame(sizes, w.name),
+                    runtime, ns / (levels + 1));
+    }
+}
@@ -0,0 +1,124 @@
+#include <scope_exit/streaming_reader.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Streaming a file once: plain reads, a reader dropping the pages on exit, and readers dropping every 8 and 64 MiB.
+// Every run starts from an evicted file; reported are the throughput and the most and the last of the file cached
+// while and after reading it.  The file is created in the working directory (tmpfs ignores the advice).
+//
+// usage: bench_streaming_reader [MiB]   (default 256)
+
+namespace
+{
+
+std::size_t const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+std::size_t resident_bytes(int fd, std::size_t size)
+{
+    void * map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        return 0;
+    }
+    std::vector<unsigned char> resident((size + page - 1) / page);
+    ::mincore(map, size, resident.data());
+    ::munmap(map, size);
+
+    std::size_t n = 0;
+    for (auto r : resident)
+    {
+        n += r & 1;
+    }
+    return n * page;
+}
+
+template <typename Read>
+void run(char const * name, int fd, std::size_t size, Read && read)
+{
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::lseek(fd, 0, SEEK_SET);
+
+    std::size_t peak = 0;
+    std::size_t chunks = 0;
+    auto const sample = [&] {
+        if (++chunks % 64 == 0)  // every 4 MiB
+        {
+            peak = std::max(peak, resident_bytes(fd, size));
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    read(sample);
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double const mib = 1024.0 * 1024.0;
+    std::printf("%-28s %10.1f MiB/s %12.1f MiB %12.1f MiB\n", name, static_cast<double>(size) / mib / seconds,
+                static_cast<double>(peak) / mib, static_cast<double>(resident_bytes(fd, size)) / mib);
+}
+
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+    std::size_t const size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256) << 20;
+    std::size_t const chunk = 1 << 16;
+
+    char name[] = "bench_streaming_reader.XXXXXX";
+    int const fd = ::mkstemp(name);
+    if (fd < 0)
+    {
+        std::perror("mkstemp");
+        return 1;
+    }
+    ::unlink(name);
+    std::vector<char> buffer(1 << 20, 'x');
+    for (std::size_t written = 0; written < size; written += buffer.size())
+    {
+        if (::write(fd, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size()))
+        {
+            std::perror("write");
+            return 1;
+        }
+    }
+    ::fsync(fd);
+    buffer.resize(chunk);
+
+    std::printf("%-28s %16s %16s %16s\n", "", "throughput", "peak cached", "cached after");
+
+    run("read(2)", fd, size, [&](auto sample) {
+        while (::read(fd, buffer.data(), chunk) > 0)
+        {
+            sample();
+        }
+    });
+
+    run("scope(streaming)", fd, size, [&](auto sample) {
+        scope(streaming, fd);
+        while (::read(fd, buffer.data(), chunk) > 0)
+        {
+            sample();
+        }
+    });
+
+    for (std::size_t every : {std::size_t{8} << 20, std::size_t{64} << 20})
+    {
+        char label[64];
+        std::snprintf(label, sizeof label, "streaming_reader, %zu MiB", every >> 20);
+        run(label, fd, size, [&](auto sample) {
+            scope_exit_v1::streaming_reader reader{fd, every};
+            while (reader.read(buffer.data(), chunk) != 0)
+            {
+                sample();
+            }
+        });
+    }
+
+    ::close(fd);
+}
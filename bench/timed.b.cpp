@@ -0,0 +1,37 @@
+#include <scope_exit/timed.hpp>
+
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <time.h>
+
+// Cost of scope(timed) around an empty scope: the clock reads alone, then the guard with context-switch sampling
+// off, on every 16th scope and on every scope.
+
+int main(int argc, char ** argv)
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    timespec ts;
+
+    bench::report("clock_gettime(CLOCK_MONOTONIC)", bench::ns_per_op(iterations, [&](std::size_t) {
+                      ::clock_gettime(CLOCK_MONOTONIC, &ts);
+                      bench::do_not_optimize(ts);
+                  }));
+    bench::report("clock_gettime(CLOCK_THREAD_CPUTIME_ID)", bench::ns_per_op(iterations, [&](std::size_t) {
+                      ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+                      bench::do_not_optimize(ts);
+                  }));
+
+    for (std::uint32_t period : {0u, 16u, 1u})
+    {
+        scope_exit_v1::timed::set_sample_period(period);
+        char name[64];
+        std::snprintf(name, sizeof name, "scope(timed) rusage sample=%s%u", period != 0 ? "1/" : "", period);
+        bench::report(name, bench::ns_per_op(iterations, [](std::size_t i) {
+                          scope(timed);
+                          bench::do_not_optimize(i);
+                      }));
+    }
+}
@@ -1,4 +1,11 @@
 function(apply_project_options target scope)
+    # target_compile_features() can still raise the standard of a target that needs more
+    set_target_properties(${target} PROPERTIES
+        CXX_STANDARD ${SCOPE_EXIT_CXX_STANDARD}
+        CXX_STANDARD_REQUIRED ON
+        CXX_EXTENSIONS OFF
+    )
+
     set(common_options
         -Wall
         -Wextra
@@ -0,0 +1,340 @@
+#pragma once
+
+/// Purpose: release many short-lived heap objects at scope exit in one batch.
+///
+/// Objects created through an `autorelease_pool` are recorded with a single append to a chunked array whose first
+/// chunk lives inside the pool object.  `make()` carves small objects out of blocks owned by the pool, and trivially
+/// destructible ones are not even recorded.  When the pool goes out of scope it destroys the objects in reverse order
+/// of registration and then frees all memory in one pass with sized deallocation.  Pools nest: the innermost pool of
+/// the calling thread is `autorelease_pool::current()`.
+///
+/// Example:
+/// ```
+///   void handle(request const & r)
+///   {
+///       scope_exit_v1::autorelease_pool pool;
+///       auto * doc = pool.make<document>(r.body());
+///       auto * idx = scope_exit_v1::autorelease_new<index>(*doc);  // goes to the innermost pool
+///   }  // idx, then doc destroyed; both freed together
+/// ```
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+class autorelease_pool
+{
+public:
+    static constexpr std::size_t inline_capacity = 32;
+    static constexpr std::size_t chunk_capacity = 256;
+
+    autorelease_pool()
+        : parent_{current_}
+    {
+        current_ = this;
+    }
+
+    autorelease_pool(autorelease_pool const &) = delete;
+    autorelease_pool & operator=(autorelease_pool const &) = delete;
+
+    ~autorelease_pool()
+    {
+        drain();
+        current_ = parent_;
+    }
+
+    /// The innermost pool of the calling thread, or nullptr.
+    static autorelease_pool * current() { return current_; }
+
+    /// The pool this one is nested in.
+    autorelease_pool * parent() const { return parent_; }
+
+    /// Allocate and construct a T owned by this pool.
+    template <typename T, typename... Args>
+    T * make(Args &&... args)
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned types are not supported");
+        constexpr bool recorded = !std::is_trivially_destructible<T>::value;
+        constexpr bool in_block = sizeof(T) <= max_block_object;
+
+        entry * e = nullptr;
+        if (recorded || !in_block)
+        {
+            e = &append();
+        }
+
+        void * mem;
+        try
+        {
+            mem = in_block ? allocate_in_block(sizeof(T)) : ::operator new(sizeof(T));
+        }
+        catch (...)
+        {
+            if (e != nullptr)
+            {
+                unappend();
+            }
+            throw;
+        }
+
+        T * object;
+        try
+        {
+            object = ::new (mem) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (in_block)
+            {
+                cursor_ = static_cast<char *>(mem);
+            }
+            else
+            {
+                ::operator delete(mem, sizeof(T));
+            }
+            if (e != nullptr)
+            {
+                unappend();
+            }
+            throw;
+        }
+
+        if (e != nullptr)
+        {
+            *e = entry{object, destroyer<T>(), in_block ? 0 : sizeof(T)};
+        }
+        ++size_;
+        return object;
+    }
+
+    /// Take ownership of an object allocated with plain `new T`.  Objects whose dynamic type may differ from T, and
+    /// over-aligned objects, which `new` allocates with the aligned overload, are released with `delete` rather than
+    /// in the sized batch.
+    template <typename T>
+    T * adopt(T * object)
+    {
+        static_assert(!std::is_array<T>::value, "arrays are not supported");
+
+        entry * e;
+        try
+        {
+            e = &append();
+        }
+        catch (...)
+        {
+            delete object;
+            throw;
+        }
+
+        if constexpr ((std::has_virtual_destructor<T>::value && !std::is_final<T>::value) ||
+                      alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            *e = entry{object, [](void * p) noexcept { delete static_cast<T *>(p); }, 0};
+        }
+        else
+        {
+            *e = entry{object, destroyer<T>(), sizeof(T)};
+        }
+        ++size_;
+        return object;
+    }
+
+    /// Number of objects currently owned by the pool.
+    std::size_t size() const { return size_; }
+
+    /// Destroy and free all owned objects now.  The pool stays usable.
+    void drain()
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        // destroy everything in reverse order of registration
+        for (chunk * c = tail_; c != nullptr; c = c->prev)
+        {
+            for (std::size_t i = c->used; i-- != 0;)
+            {
+                entry const & e = c->entries()[i];
+                if (e.destroy != nullptr)
+                {
+                    e.destroy(e.ptr);
+                }
+            }
+        }
+        for (std::size_t i = inline_used_; i-- != 0;)
+        {
+            if (inline_[i].destroy != nullptr)
+            {
+                inline_[i].destroy(inline_[i].ptr);
+            }
+        }
+
+        // then return the memory in one pass
+        for (std::size_t i = 0; i != inline_used_; ++i)
+        {
+            deallocate(inline_[i]);
+        }
+        while (tail_ != nullptr)
+        {
+            chunk * c = tail_;
+            for (std::size_t i = 0; i != c->used; ++i)
+            {
+                deallocate(c->entries()[i]);
+            }
+            tail_ = c->prev;
+            ::operator delete(c, chunk_bytes);
+        }
+        while (blocks_ != nullptr)
+        {
+            block * b = blocks_;
+            blocks_ = b->prev;
+            ::operator delete(b, b->size);
+        }
+
+        cursor_ = nullptr;
+        limit_ = nullptr;
+        inline_used_ = 0;
+        size_ = 0;
+    }
+
+private:
+    struct entry
+    {
+        void * ptr;
+        void (*destroy)(void *) noexcept;
+        std::size_t size;  // 0 when the memory belongs to a block or `destroy` also frees it
+    };
+
+    struct block
+    {
+        block * prev;
+        std::size_t size;
+    };
+
+    struct chunk
+    {
+        chunk * prev;
+        std::size_t used;
+
+        entry * entries() { return reinterpret_cast<entry *>(this + 1); }
+    };
+
+    static constexpr std::size_t chunk_bytes = sizeof(chunk) + chunk_capacity * sizeof(entry);
+    static constexpr std::size_t first_block_bytes = 4096;
+    static constexpr std::size_t max_block_bytes = 64 * 1024;
+    static constexpr std::size_t max_block_object = 512;
+
+    template <typename T>
+    static constexpr auto destroyer() -> void (*)(void *) noexcept
+    {
+        if constexpr (std::is_trivially_destructible<T>::value)
+        {
+            return nullptr;
+        }
+        else
+        {
+            return [](void * p) noexcept { static_cast<T *>(p)->~T(); };
+        }
+    }
+
+    static void deallocate(entry const & e)
+    {
+        if (e.size != 0)
+        {
+            ::operator delete(e.ptr, e.size);
+        }
+    }
+
+    // Reserve the next slot.  The only operation that can throw is allocating a new chunk.
+    entry & append()
+    {
+        if (inline_used_ != inline_capacity)
+        {
+            return inline_[inline_used_++];
+        }
+
+        if (tail_ == nullptr || tail_->used == chunk_capacity)
+        {
+            auto * c = static_cast<chunk *>(::operator new(chunk_bytes));
+            c->prev = tail_;
+            c->used = 0;
+            tail_ = c;
+        }
+        return tail_->entries()[tail_->used++];
+    }
+
+    void * allocate_in_block(std::size_t size)
+    {
+        constexpr std::size_t align = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+        size = (size + align - 1) & ~(align - 1);
+
+        if (static_cast<std::size_t>(limit_ - cursor_) < size)
+        {
+            std::size_t bytes = blocks_ == nullptr ? first_block_bytes : blocks_->size * 2;
+            bytes = bytes < max_block_bytes ? bytes : max_block_bytes;
+
+            auto * b = static_cast<block *>(::operator new(bytes));
+            b->prev = blocks_;
+            b->size = bytes;
+            blocks_ = b;
+            cursor_ = reinterpret_cast<char *>(b) + ((sizeof(block) + align - 1) & ~(align - 1));
+            limit_ = reinterpret_cast<char *>(b) + bytes;
+        }
+
+        void * p = cursor_;
+        cursor_ += size;
+        return p;
+    }
+
+    void unappend()
+    {
+        if (tail_ != nullptr && tail_->used != 0)
+        {
+            --tail_->used;
+        }
+        else
+        {
+            --inline_used_;
+        }
+    }
+
+    static thread_local autorelease_pool * current_;
+
+    autorelease_pool * parent_;
+    std::size_t size_ = 0;
+    std::size_t inline_used_ = 0;
+    chunk * tail_ = nullptr;
+    block * blocks_ = nullptr;
+    char * cursor_ = nullptr;
+    char * limit_ = nullptr;
+    entry inline_[inline_capacity];
+};
+
+inline thread_local autorelease_pool * autorelease_pool::current_ = nullptr;
+
+/// Create a T owned by the calling thread's innermost autorelease pool.  There must be an active pool.
+template <typename T, typename... Args>
+T * autorelease_new(Args &&... args)
+{
+    return autorelease_pool::current()->make<T>(std::forward<Args>(args)...);
+}
+
+/// Hand an object created with `new` to the calling thread's innermost autorelease pool.
+template <typename T>
+T * autorelease(T * object)
+{
+    return autorelease_pool::current()->adopt(object);
+}
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,229 @@
+#pragma once
+
+/// Purpose: wake consumers once per batch instead of once per message (Linux only).
+///
+/// A `batched_notifier` owns an eventfd that consumers wait on with `poll`/`epoll` or `wait()`.  `notify()` outside a
+/// batch writes the eventfd right away, one system call per message.  Inside `scope(notify_batch, notifier)` the
+/// notifications are added up per thread instead, and the outermost batch scope of that notifier on the thread
+/// writes the total once when it exits, on every exit path since the messages are already queued.  Nested batch
+/// scopes, including ones opened deeper in the call stack by code that knows nothing about the outer one, fold into
+/// the outermost.  The eventfd counter carries the number of messages, so a consumer can drain that many.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::batched_notifier ready;
+///
+///   void produce(std::vector<job> const & jobs)
+///   {
+///       scope(notify_batch, ready);       // one eventfd write when the loop is done
+///       for (auto const & j : jobs)
+///       {
+///           queue.push(j);
+///           ready.notify();
+///       }
+///   }
+///
+///   void consume()
+///   {
+///       while (auto n = ready.wait())     // or poll ready.fd() along with other descriptors
+///       {
+///           drain(queue, n);
+///       }
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace scope_exit_v1
+{
+
+class batched_notifier;
+
+namespace detail
+{
+
+// One open batch scope.  The frames of a thread form a stack; `owner` is the outermost frame of the same notifier.
+struct notify_frame
+{
+    batched_notifier * notifier;
+    notify_frame * owner;
+    notify_frame * prev;
+    std::uint64_t pending;
+};
+
+inline notify_frame *& notify_frames()
+{
+    thread_local notify_frame * top = nullptr;
+    return top;
+}
+
+}  // namespace detail
+
+class batched_notifier
+{
+public:
+    /// Coalesces the notifications of the calling thread until the outermost batch scope of the notifier exits.
+    /// Batch scopes must be nested on one thread, as block scopes are.
+    class batch
+    {
+    public:
+        explicit batch(batched_notifier & notifier)
+            : frame_{&notifier, &frame_, detail::notify_frames(), 0}
+        {
+            for (auto * f = frame_.prev; f != nullptr; f = f->prev)
+            {
+                if (f->notifier == &notifier)
+                {
+                    frame_.owner = f->owner;
+                    break;
+                }
+            }
+            detail::notify_frames() = &frame_;
+        }
+
+        batch(batch const &) = delete;
+        batch & operator=(batch const &) = delete;
+
+        ~batch()
+        {
+            detail::notify_frames() = frame_.prev;
+            if (frame_.owner == &frame_ && frame_.pending != 0)
+            {
+                frame_.notifier->signal(frame_.pending);
+            }
+        }
+
+        /// Notifications held back so far, by this scope and the ones it is folded into.
+        std::uint64_t pending() const { return frame_.owner->pending; }
+
+    private:
+        detail::notify_frame frame_;
+    };
+
+    batched_notifier()
+        : fd_{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+    {
+        if (fd_ < 0)
+        {
+            throw std::system_error(errno, std::system_category(), "eventfd");
+        }
+    }
+
+    batched_notifier(batched_notifier const &) = delete;
+    batched_notifier & operator=(batched_notifier const &) = delete;
+
+    ~batched_notifier() { ::close(fd_); }
+
+    /// Non-blocking eventfd to poll for readability.
+    int fd() const { return fd_; }
+
+    /// Announce `count` messages: held back by an open batch scope of this notifier on the calling thread, written
+    /// to the eventfd otherwise.
+    void notify(std::uint64_t count = 1)
+    {
+        for (auto * f = detail::notify_frames(); f != nullptr; f = f->prev)
+        {
+            if (f->notifier == this)
+            {
+                f->owner->pending += count;
+                return;
+            }
+        }
+        signal(count);
+    }
+
+    /// Take the number of messages announced since the last call, without blocking; 0 if there are none.
+    std::uint64_t consume()
+    {
+        std::uint64_t count = 0;
+        while (::read(fd_, &count, sizeof count) < 0)
+        {
+            if (errno == EAGAIN)
+            {
+                return 0;
+            }
+            if (errno != EINTR)
+            {
+                throw std::system_error(errno, std::system_category(), "read");
+            }
+        }
+        return count;
+    }
+
+    /// Wait up to `timeout_ms` (-1: forever) for notifications and take them; 0 only once the timeout has passed.
+    /// Another consumer may take the notifications between the wakeup and the read; the wait then goes on for the
+    /// time left.
+    std::uint64_t wait(int timeout_ms = -1)
+    {
+        using clock = std::chrono::steady_clock;
+        auto const deadline = clock::now() + std::chrono::milliseconds{timeout_ms};
+        for (int left = timeout_ms;;)
+        {
+            pollfd p{fd_, POLLIN, 0};
+            int const rc = ::poll(&p, 1, left);
+            if (rc < 0 && errno != EINTR)
+            {
+                throw std::system_error(errno, std::system_category(), "poll");
+            }
+            if (rc > 0)
+            {
+                if (auto count = consume())
+                {
+                    return count;
+                }
+            }
+            if (timeout_ms >= 0)
+            {
+                auto const now = clock::now();
+                if (now >= deadline)
+                {
+                    return 0;
+                }
+                // rounded up, so the wait does not end early
+                left = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count());
+            }
+        }
+    }
+
+    /// Successful eventfd writes so far.
+    std::uint64_t writes() const { return writes_.load(std::memory_order_relaxed); }
+
+private:
+    // Write failures are left alone: EAGAIN means the counter is saturated, so the consumer is due to wake anyway.
+    void signal(std::uint64_t count) noexcept
+    {
+        ssize_t rc;
+        while ((rc = ::write(fd_, &count, sizeof count)) < 0 && errno == EINTR)
+        {
+        }
+        if (rc == static_cast<ssize_t>(sizeof count))
+        {
+            writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    int fd_;
+    std::atomic<std::uint64_t> writes_{0};
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_notify_batch(notifier)                                                                                   \
+    [[maybe_unused]] scope_exit_v1::batched_notifier::batch const SCOPE_CONCAT_(scope_notify_batch_obj_,              \
+                                                                                __COUNTER__)(notifier)
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
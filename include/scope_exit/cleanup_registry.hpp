@@ -0,0 +1,314 @@
+#pragma once
+
+/// Purpose: keyed cleanup actions that run once per key at scope exit.
+///
+/// Registering `scope(exit) { flush(file); }` inside a loop runs the same flush once per iteration.  A
+/// `cleanup_registry` coalesces actions registered with the same key into a single execution when the registry goes
+/// out of scope.  Either the first or the last registration for a key wins.  Keys are tracked in a small inline hash
+/// set, and the first `InlineCapacity` actions are stored inside the registry without allocation as long as they
+/// are small (up to three pointers, e.g. a lambda capturing three references).
+///
+/// Example:
+/// ```
+///   scope_exit_v1::cleanup_registry<> cleanups;
+///   for (auto const & rec : batch)
+///   {
+///       auto & file = file_for(rec);
+///       write(file, rec);
+///       cleanups.defer(&file, [&file] { flush(file); });  // one flush per file
+///   }
+/// ```
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace scope_exit_v1
+{
+
+/// Which registration of a duplicate key is executed.
+enum class coalesce
+{
+    first_wins,
+    last_wins,
+};
+
+template <coalesce Policy = coalesce::first_wins, std::size_t InlineCapacity = 16>
+class cleanup_registry
+{
+public:
+    using key_type = std::uintptr_t;
+
+    cleanup_registry() { clear_index(); }
+
+    cleanup_registry(cleanup_registry const &) = delete;
+    cleanup_registry & operator=(cleanup_registry const &) = delete;
+
+    ~cleanup_registry() noexcept(false) { run(); }
+
+    /// Register `action` under `key`.  Returns true for the first registration of the key.  If storing the action
+    /// throws, the registry is unchanged: with `last_wins` the action registered before stays in place.
+    template <typename F>
+    bool defer(key_type key, F && action)
+    {
+        auto slot = find_slot(key);
+        if (index_[slot] != empty)
+        {
+            if constexpr (Policy == coalesce::last_wins)
+            {
+                at(index_[slot]).replace(std::forward<F>(action));
+            }
+            return false;
+        }
+
+        std::uint32_t pos = static_cast<std::uint32_t>(size_);
+        entry & e = size_ < InlineCapacity ? *::new (&inline_[size_]) entry{key}
+                                           : *overflow_.emplace_back(std::make_unique<entry>(key));
+        try
+        {
+            e.assign(std::forward<F>(action));
+        }
+        catch (...)
+        {
+            if (size_ < InlineCapacity)
+            {
+                e.~entry();
+            }
+            else
+            {
+                overflow_.pop_back();
+            }
+            throw;
+        }
+
+        ++size_;
+        index_[slot] = pos;
+        if (size_ * 2 > index_mask_ + 1)
+        {
+            grow_index();
+        }
+        return true;
+    }
+
+    template <typename T, typename F>
+    bool defer(T * key, F && action)
+    {
+        return defer(reinterpret_cast<key_type>(key), std::forward<F>(action));
+    }
+
+    /// Number of distinct keys with a pending action.
+    std::size_t size() const { return size_; }
+
+    bool contains(key_type key) const { return index_[find_slot(key)] != empty; }
+
+    /// Run the pending actions now, most recently registered key first, and empty the registry.  If an action
+    /// throws, the remaining actions are discarded and the exception propagates.
+    void run()
+    {
+        std::size_t n = size_;
+        try
+        {
+            while (n != 0)
+            {
+                at(static_cast<std::uint32_t>(--n)).invoke();
+            }
+        }
+        catch (...)
+        {
+            reset();
+            throw;
+        }
+        reset();
+    }
+
+    /// Drop all pending actions without running them.
+    void reset()
+    {
+        for (std::size_t i = 0; i != size_ && i != InlineCapacity; ++i)
+        {
+            inline_[i].~entry();
+        }
+        overflow_.clear();
+        size_ = 0;
+        if (!heap_index_.empty())
+        {
+            heap_index_ = {};
+            index_ = inline_index_;
+            index_mask_ = index_inline_size - 1;
+        }
+        clear_index();
+    }
+
+private:
+    static constexpr std::uint32_t empty = ~std::uint32_t{0};
+    static constexpr std::size_t index_inline_size = [] {
+        std::size_t n = 4;
+        while (n < InlineCapacity * 2)
+        {
+            n *= 2;
+        }
+        return n;
+    }();
+
+    // Type-erased action with an inline buffer for small callables.
+    struct entry
+    {
+        static constexpr std::size_t buffer_size = 3 * sizeof(void *);
+
+        explicit entry(key_type k)
+            : key{k}
+        {}
+
+        entry(entry const &) = delete;
+        entry & operator=(entry const &) = delete;
+
+        ~entry() { reset(); }
+
+        template <typename Fn>
+        static constexpr bool stored_inline = sizeof(Fn) <= buffer_size && alignof(Fn) <= alignof(void *);
+
+        // Store into an empty entry.
+        template <typename F>
+        void assign(F && f)
+        {
+            using fn = std::decay_t<F>;
+            if constexpr (stored_inline<fn>)
+            {
+                ::new (static_cast<void *>(buffer)) fn(std::forward<F>(f));
+                call = [](void * p) { (*static_cast<fn *>(p))(); };
+                destroy = [](void * p) noexcept { static_cast<fn *>(p)->~fn(); };
+                target = buffer;
+            }
+            else
+            {
+                own(new fn(std::forward<F>(f)));
+            }
+        }
+
+        // Store in place of the current action, which is kept if constructing the new one throws.  Only actions
+        // that go into the buffer without throwing skip the heap.
+        template <typename F>
+        void replace(F && f)
+        {
+            using fn = std::decay_t<F>;
+            if constexpr (stored_inline<fn> && std::is_nothrow_constructible<fn, F &&>::value)
+            {
+                reset();
+                assign(std::forward<F>(f));
+            }
+            else
+            {
+                std::unique_ptr<fn> p{new fn(std::forward<F>(f))};
+                reset();
+                own(p.release());
+            }
+        }
+
+        template <typename Fn>
+        void own(Fn * p) noexcept
+        {
+            target = p;
+            call = [](void * q) { (*static_cast<Fn *>(q))(); };
+            destroy = [](void * q) noexcept { delete static_cast<Fn *>(q); };
+        }
+
+        void invoke()
+        {
+            if (destroy != nullptr)
+            {
+                call(target);
+            }
+        }
+
+        void reset()
+        {
+            if (destroy != nullptr)
+            {
+                destroy(target);
+                destroy = nullptr;
+            }
+        }
+
+        key_type key;
+        void (*call)(void *) = nullptr;
+        void (*destroy)(void *) noexcept = nullptr;
+        void * target = nullptr;
+        alignas(void *) unsigned char buffer[buffer_size];
+    };
+
+    static std::size_t mix(key_type key)
+    {
+        std::uint64_t h = key;
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 32;
+        return static_cast<std::size_t>(h);
+    }
+
+    entry & at(std::uint32_t pos) { return pos < InlineCapacity ? inline_[pos] : *overflow_[pos - InlineCapacity]; }
+
+    entry const & at(std::uint32_t pos) const
+    {
+        return pos < InlineCapacity ? inline_[pos] : *overflow_[pos - InlineCapacity];
+    }
+
+    // Slot holding `key`, or the empty slot where it would be inserted.
+    std::size_t find_slot(key_type key) const
+    {
+        for (std::size_t i = mix(key) & index_mask_;; i = (i + 1) & index_mask_)
+        {
+            if (index_[i] == empty || at(index_[i]).key == key)
+            {
+                return i;
+            }
+        }
+    }
+
+    void clear_index()
+    {
+        for (std::size_t i = 0; i <= index_mask_; ++i)
+        {
+            index_[i] = empty;
+        }
+    }
+
+    void grow_index()
+    {
+        std::vector<std::uint32_t> bigger((index_mask_ + 1) * 2, empty);
+        index_mask_ = bigger.size() - 1;
+        for (std::uint32_t pos = 0; pos != size_; ++pos)
+        {
+            std::size_t i = mix(at(pos).key) & index_mask_;
+            while (bigger[i] != empty)
+            {
+                i = (i + 1) & index_mask_;
+            }
+            bigger[i] = pos;
+        }
+        heap_index_ = std::move(bigger);
+        index_ = heap_index_.data();
+    }
+
+    std::size_t size_ = 0;
+    std::uint32_t * index_ = inline_index_;
+    std::size_t index_mask_ = index_inline_size - 1;
+    std::uint32_t inline_index_[index_inline_size];
+    union
+    {
+        entry inline_[InlineCapacity];
+    };
+    std::vector<std::unique_ptr<entry>> overflow_;
+    std::vector<std::uint32_t> heap_index_;
+};
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,235 @@
+#pragma once
+
+/// Purpose: per-thread typed context (request id, tenant, deadline, ...) pushed and popped with the scope.
+///
+/// Every context type T has its own per-thread stack with fixed inline capacity (`context_capacity<T>`, 16 by
+/// default).  `context_guard<T>` pushes a value on construction and pops it on destruction; `current_context<T>()`
+/// returns the innermost value in O(1) without allocating.  To carry the context over to a thread-pool task, capture
+/// it on the submitting thread and restore it inside the task.
+///
+/// Example:
+/// ```
+///   void handle(request const & r)
+///   {
+///       scope(context, request_id, r.id());
+///       log("handling");  // log() reads current_context<request_id>()
+///
+///       auto ctx = scope_exit_v1::capture_context<request_id, tenant>();
+///       pool.submit([ctx] {
+///           auto restored = ctx.restore();
+///           work();
+///       });
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+/// Maximum nesting depth of context values of type T on one thread.
+template <typename T>
+constexpr std::size_t context_capacity = 16;
+
+namespace detail
+{
+
+template <typename T>
+class context_stack
+{
+public:
+    static constexpr std::size_t capacity = context_capacity<T>;
+
+    static context_stack & local()
+    {
+        static thread_local context_stack stack;
+        return stack;
+    }
+
+    T const * top() const { return top_; }
+
+    std::size_t depth() const { return depth_; }
+
+    template <typename... Args>
+    void push(Args &&... args)
+    {
+        if (depth_ == capacity)
+        {
+            throw std::length_error("context stack overflow");
+        }
+        if constexpr (std::is_constructible<T, Args &&...>::value)
+        {
+            top_ = ::new (static_cast<void *>(storage_[depth_])) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            top_ = ::new (static_cast<void *>(storage_[depth_])) T{std::forward<Args>(args)...};
+        }
+        ++depth_;
+    }
+
+    void pop()
+    {
+        top_->~T();
+        --depth_;
+        top_ = depth_ == 0 ? nullptr : std::launder(reinterpret_cast<T *>(storage_[depth_ - 1]));
+    }
+
+private:
+    // zero-initialized so that the thread_local needs no dynamic initialization
+    alignas(T) unsigned char storage_[capacity][sizeof(T)] = {};
+    T * top_ = nullptr;
+    std::size_t depth_ = 0;
+};
+
+}  // namespace detail
+
+/// The calling thread's innermost context value of type T, or nullptr.
+template <typename T>
+T const * current_context()
+{
+    return detail::context_stack<T>::local().top();
+}
+
+/// Nesting depth of context values of type T on the calling thread.
+template <typename T>
+std::size_t context_depth()
+{
+    return detail::context_stack<T>::local().depth();
+}
+
+/// Pushes a context value for the lifetime of the guard.  Throws std::length_error when the stack is full.
+template <typename T>
+class context_guard
+{
+public:
+    template <typename... Args>
+    explicit context_guard(Args &&... args)
+    {
+        detail::context_stack<T>::local().push(std::forward<Args>(args)...);
+    }
+
+    context_guard(context_guard const &) = delete;
+    context_guard & operator=(context_guard const &) = delete;
+
+    ~context_guard() { detail::context_stack<T>::local().pop(); }
+};
+
+/// Restores captured context values on another thread for the lifetime of the guard.
+template <typename... Ts>
+class context_restore_guard
+{
+public:
+    explicit context_restore_guard(std::tuple<std::optional<Ts>...> const & values)
+    {
+        push_from<0>(values);
+    }
+
+    context_restore_guard(context_restore_guard const &) = delete;
+    context_restore_guard & operator=(context_restore_guard const &) = delete;
+
+    ~context_restore_guard() { pop_from<sizeof...(Ts)>(); }
+
+private:
+    template <std::size_t I>
+    void push_from(std::tuple<std::optional<Ts>...> const & values)
+    {
+        if constexpr (I != sizeof...(Ts))
+        {
+            using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+            auto const & value = std::get<I>(values);
+            if (value)
+            {
+                try
+                {
+                    detail::context_stack<T>::local().push(*value);
+                }
+                catch (...)
+                {
+                    pop_from<I>();
+                    throw;
+                }
+                pushed_ |= 1u << I;
+            }
+            push_from<I + 1>(values);
+        }
+    }
+
+    // Pop the values pushed for the first `N` types, in reverse order.
+    template <std::size_t N>
+    void pop_from()
+    {
+        if constexpr (N != 0)
+        {
+            using T = std::tuple_element_t<N - 1, std::tuple<Ts...>>;
+            if (pushed_ & (1u << (N - 1)))
+            {
+                detail::context_stack<T>::local().pop();
+            }
+            pop_from<N - 1>();
+        }
+    }
+
+    static_assert(sizeof...(Ts) <= 32, "too many context types");
+
+    unsigned pushed_ = 0;
+};
+
+/// Snapshot of the innermost context values of the given types, for handing off to another thread.
+template <typename... Ts>
+class context_capture
+{
+public:
+    context_capture()
+        : values_{current_value<Ts>()...}
+    {}
+
+    /// Push the captured values onto the calling thread's stacks until the returned guard is destroyed.
+    context_restore_guard<Ts...> restore() const { return context_restore_guard<Ts...>{values_}; }
+
+    template <typename T>
+    T const * get() const
+    {
+        auto const & value = std::get<std::optional<T>>(values_);
+        return value ? &*value : nullptr;
+    }
+
+private:
+    template <typename T>
+    static std::optional<T> current_value()
+    {
+        if (T const * value = current_context<T>())
+        {
+            return *value;
+        }
+        return std::nullopt;
+    }
+
+    std::tuple<std::optional<Ts>...> values_;
+};
+
+template <typename... Ts>
+context_capture<Ts...> capture_context()
+{
+    return {};
+}
+
+}  // namespace scope_exit_v1
+
+#define scope_context(type, ...)                                                                                       \
+    [[maybe_unused]] scope_exit_v1::context_guard<type> const SCOPE_CONCAT_(scope_context_guard_obj_,                  \
+                                                                            __COUNTER__){__VA_ARGS__}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,285 @@
+#pragma once
+
+/// Purpose: run a callback when a scope outlives its deadline, without creating an OS timer per scope.
+///
+/// Deadlines are kept in a per-thread hierarchical timer wheel.  Arming is O(1) on guard construction and the guard
+/// unlinks its node in O(1) when the scope exits.  The owning thread drives the wheel by calling
+/// `timer_wheel::local().advance()` from its event loop or at convenient checkpoints; expired callbacks run there.
+///
+/// Example:
+/// ```
+///   scope(deadline, 20ms) { send_hedged_request(); };
+///   auto reply = wait_for_reply();  // the loop inside calls timer_wheel::local().advance()
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+/// Hashed hierarchical timer wheel: 4 levels of 64 slots plus an overflow list.  With the default 1ms tick the
+/// wheel spans about 4.6 hours before timers go to overflow.
+class timer_wheel
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slots = 1u << slot_bits;
+    static constexpr unsigned levels = 4;
+
+    /// Intrusive timer node.  The wheel never owns timers; they must stay alive while armed.
+    struct timer
+    {
+        void (*fire)(void * context) = nullptr;
+        void * context = nullptr;
+        timer * next = nullptr;
+        timer ** pprev = nullptr;
+        std::uint64_t expiry = 0;
+
+        bool armed() const { return pprev != nullptr; }
+    };
+
+    explicit timer_wheel(clock::duration tick = std::chrono::milliseconds{1}, clock::time_point start = clock::now())
+        : start_{start}
+        , tick_{tick}
+    {}
+
+    timer_wheel(timer_wheel const &) = delete;
+    timer_wheel & operator=(timer_wheel const &) = delete;
+
+    /// The calling thread's wheel.
+    static timer_wheel & local()
+    {
+        static thread_local timer_wheel wheel;
+        return wheel;
+    }
+
+    /// Arm `t` to fire at the first advance() at or after `deadline`.
+    void arm(timer & t, clock::time_point deadline)
+    {
+        auto ticks = deadline <= start_ ? 0 : (deadline - start_ + tick_ - clock::duration{1}) / tick_;
+        t.expiry = static_cast<std::uint64_t>(ticks);
+        if (t.expiry <= now_)
+        {
+            t.expiry = now_ + 1;
+        }
+
+        insert(t);
+        ++size_;
+    }
+
+    /// Disarm `t`.  O(1); does nothing if the timer has already fired.
+    void cancel(timer & t)
+    {
+        if (t.armed())
+        {
+            unlink(t);
+            --size_;
+        }
+    }
+
+    /// Fire every timer whose deadline is at or before `now`.  Returns the number of fired timers.
+    std::size_t advance(clock::time_point now = clock::now())
+    {
+        auto const target = now <= start_ ? 0 : static_cast<std::uint64_t>((now - start_) / tick_);
+        std::size_t fired = 0;
+
+        while (now_ < target)
+        {
+            // ticks without a slot to fire or cascade change nothing: jump past them, also over long idle gaps
+            std::uint64_t const next = size_ == 0 ? target + 1 : next_event();
+            if (next > target)
+            {
+                now_ = target;
+                break;
+            }
+
+            now_ = next;
+            cascade();
+
+            auto & slot = wheel_[0][now_ & (slots - 1)];
+            while (slot != nullptr)
+            {
+                timer & t = *slot;
+                unlink(t);
+                --size_;
+                ++fired;
+                t.fire(t.context);
+            }
+        }
+
+        return fired;
+    }
+
+    /// Number of armed timers.
+    std::size_t size() const { return size_; }
+
+    clock::duration tick() const { return tick_; }
+
+private:
+    static void link(timer *& head, timer & t)
+    {
+        t.next = head;
+        t.pprev = &head;
+        if (head != nullptr)
+        {
+            head->pprev = &t.next;
+        }
+        head = &t;
+    }
+
+    static void unlink(timer & t)
+    {
+        *t.pprev = t.next;
+        if (t.next != nullptr)
+        {
+            t.next->pprev = t.pprev;
+        }
+        t.next = nullptr;
+        t.pprev = nullptr;
+    }
+
+    // Place the timer on the lowest level whose slot range still contains the current tick.
+    void insert(timer & t)
+    {
+        for (unsigned level = 0; level != levels; ++level)
+        {
+            unsigned shift = slot_bits * (level + 1);
+            if ((t.expiry >> shift) == (now_ >> shift))
+            {
+                auto const index = (t.expiry >> (shift - slot_bits)) & (slots - 1);
+                link(wheel_[level][index], t);
+                occupied_[level] |= std::uint64_t{1} << index;
+                return;
+            }
+        }
+
+        link(overflow_, t);
+    }
+
+    // The first tick after now_ at which a level-0 slot fires or an upper slot (or the overflow list) cascades.
+    // Slots at or before the current position of their level are always empty, since insert() puts later expiries
+    // there only.  Occupancy bits of slots emptied by cancel() are cleared here, lazily.
+    std::uint64_t next_event()
+    {
+        std::uint64_t next = ~std::uint64_t{0};
+        for (unsigned level = 0; level != levels; ++level)
+        {
+            unsigned const shift = slot_bits * level;
+            auto const position = (now_ >> shift) & (slots - 1);
+            std::uint64_t ahead = position + 1 == slots ? 0 : occupied_[level] & (~std::uint64_t{0} << (position + 1));
+            while (ahead != 0)
+            {
+                auto const index = static_cast<unsigned>(__builtin_ctzll(ahead));
+                if (wheel_[level][index] != nullptr)
+                {
+                    std::uint64_t const rotation = now_ >> (shift + slot_bits) << (shift + slot_bits);
+                    next = std::min(next, rotation + (std::uint64_t{index} << shift));
+                    break;
+                }
+                occupied_[level] &= ~(std::uint64_t{1} << index);
+                ahead &= ahead - 1;
+            }
+        }
+        if (overflow_ != nullptr)
+        {
+            unsigned const span = slot_bits * levels;
+            next = std::min(next, ((now_ >> span) + 1) << span);
+        }
+        return next;
+    }
+
+    // When the lower bits of the current tick wrap, move the timers of the next slot on the upper level down.
+    void cascade()
+    {
+        for (unsigned level = 1; level <= levels; ++level)
+        {
+            unsigned shift = slot_bits * level;
+            if ((now_ & ((std::uint64_t{1} << shift) - 1)) != 0)
+            {
+                return;
+            }
+
+            timer * list = level == levels ? overflow_ : wheel_[level][(now_ >> shift) & (slots - 1)];
+            if (level == levels)
+            {
+                overflow_ = nullptr;
+            }
+            else
+            {
+                wheel_[level][(now_ >> shift) & (slots - 1)] = nullptr;
+            }
+
+            while (list != nullptr)
+            {
+                timer & t = *list;
+                list = t.next;
+                insert(t);
+            }
+        }
+    }
+
+    timer * wheel_[levels][slots] = {};
+    std::uint64_t occupied_[levels] = {};  // bit per slot that may hold timers
+    timer * overflow_ = nullptr;
+    clock::time_point start_;
+    clock::duration tick_;
+    std::uint64_t now_ = 0;
+    std::size_t size_ = 0;
+};
+
+namespace detail
+{
+
+template <typename F>
+struct scope_deadline_guard
+{
+    scope_deadline_guard(timer_wheel::clock::duration timeout, F && f)
+        : action{std::move(f)}
+    {
+        node.fire = &fire;
+        node.context = this;
+        wheel.arm(node, timer_wheel::clock::now() + timeout);
+    }
+
+    scope_deadline_guard(scope_deadline_guard const &) = delete;
+
+    ~scope_deadline_guard() { wheel.cancel(node); }
+
+    static void fire(void * self) { static_cast<scope_deadline_guard *>(self)->action(); }
+
+    timer_wheel & wheel = timer_wheel::local();
+    mutable timer_wheel::timer node;
+    mutable F action;
+};
+
+struct scope_deadline_guard_tag
+{
+    template <typename F>
+    friend auto operator+(scope_deadline_guard_tag tag, F f)
+    {
+        return scope_deadline_guard<F>(tag.timeout, std::move(f));
+    }
+
+    timer_wheel::clock::duration timeout;
+};
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+#define scope_deadline(timeout)                                                                                        \
+    [[maybe_unused]] auto const SCOPE_CONCAT_(scope_deadline_guard_obj_, __COUNTER__) =                                \
+        scope_exit_v1::detail::scope_deadline_guard_tag{timeout} + [&]
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
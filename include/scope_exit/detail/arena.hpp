@@ -0,0 +1,146 @@
+#pragma once
+
+/// Purpose: monotonic arena with O(1) rewind to a saved position.
+///
+/// Memory is carved from a chain of blocks.  Rewinding only moves the cursor back; blocks past the saved position
+/// stay in the chain and are reused by later allocations, so scopes that repeatedly allocate and rewind reach a
+/// steady state without touching the heap.
+
+#include <cstddef>
+#include <new>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+class arena
+{
+public:
+    struct position
+    {
+        void * block;
+        char * cursor;
+    };
+
+    explicit arena(std::size_t block_size = 16 * 1024)
+        : block_size_{block_size}
+    {}
+
+    arena(arena const &) = delete;
+    arena & operator=(arena const &) = delete;
+
+    ~arena()
+    {
+        while (head_ != nullptr)
+        {
+            block * b = head_;
+            head_ = b->next;
+            ::operator delete(b, b->size);
+        }
+    }
+
+    void * allocate(std::size_t size, std::size_t align)
+    {
+        if (current_ != nullptr)
+        {
+            if (void * p = bump(size, align))
+            {
+                return p;
+            }
+        }
+        return allocate_slow(size, align);
+    }
+
+    position save() const { return {current_, cursor_}; }
+
+    /// Release everything allocated after `pos` was saved.
+    void rewind(position pos)
+    {
+        current_ = static_cast<block *>(pos.block);
+        cursor_ = pos.cursor;
+        limit_ = current_ != nullptr ? reinterpret_cast<char *>(current_) + current_->size : nullptr;
+    }
+
+    /// Total bytes held in blocks.
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for (block * b = head_; b != nullptr; b = b->next)
+        {
+            total += b->size;
+        }
+        return total;
+    }
+
+private:
+    struct block
+    {
+        block * next;
+        std::size_t size;
+    };
+
+    void * bump(std::size_t size, std::size_t align)
+    {
+        auto addr = reinterpret_cast<std::size_t>(cursor_);
+        auto aligned = (addr + align - 1) & ~(align - 1);
+        if (aligned + size > reinterpret_cast<std::size_t>(limit_))
+        {
+            return nullptr;
+        }
+        cursor_ = reinterpret_cast<char *>(aligned + size);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    // Make `b` current and carve the first allocation out of it; the caller has checked that it fits.
+    void * start(block * b, std::size_t size, std::size_t align)
+    {
+        current_ = b;
+        limit_ = reinterpret_cast<char *>(b) + b->size;
+        auto aligned = (reinterpret_cast<std::size_t>(b + 1) + align - 1) & ~(align - 1);
+        cursor_ = reinterpret_cast<char *>(aligned + size);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    void * allocate_slow(std::size_t size, std::size_t align)
+    {
+        // reuse the block kept after the current one by an earlier rewind if the request fits
+        block * prev = current_;
+        block * next = prev != nullptr ? prev->next : head_;
+        if (next != nullptr && next->size - sizeof(block) >= size + align)
+        {
+            return start(next, size, align);
+        }
+
+        std::size_t needed = sizeof(block) + size + align;
+        std::size_t bytes = needed > block_size_ ? needed : block_size_;
+        auto * b = static_cast<block *>(::operator new(bytes));
+        b->size = bytes;
+        b->next = next;
+        if (prev != nullptr)
+        {
+            prev->next = b;
+        }
+        else
+        {
+            head_ = b;
+        }
+
+        return start(b, size, align);
+    }
+
+    std::size_t block_size_;
+    block * head_ = nullptr;
+    block * current_ = nullptr;
+    char * cursor_ = nullptr;
+    char * limit_ = nullptr;
+};
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,108 @@
+#pragma once
+
+/// Purpose: wait on and wake a 32-bit atomic word.
+///
+/// Uses futex(2) on Linux.  Elsewhere it falls back to a small table of mutex/condition variable buckets keyed by
+/// the word address.  Spurious wakeups are possible in both cases, so callers always re-check their condition.
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+#if defined(__linux__)
+
+template <typename T>
+inline void futex_wait(std::atomic<T> & word, T expected)
+{
+    static_assert(sizeof(std::atomic<T>) == 4, "futex word must be 32 bits");
+    ::syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+template <typename T>
+inline void futex_wait_for(std::atomic<T> & word, T expected, std::chrono::nanoseconds timeout)
+{
+    static_assert(sizeof(std::atomic<T>) == 4, "futex word must be 32 bits");
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts{static_cast<time_t>(secs.count()), static_cast<long>((timeout - secs).count())};
+    ::syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+}
+
+template <typename T>
+inline void futex_wake(std::atomic<T> & word, int count = INT_MAX)
+{
+    static_assert(sizeof(std::atomic<T>) == 4, "futex word must be 32 bits");
+    ::syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+#else
+
+struct futex_bucket
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+inline futex_bucket & futex_bucket_for(void const * addr)
+{
+    static futex_bucket buckets[64];
+    return buckets[(reinterpret_cast<std::uintptr_t>(addr) >> 4) % 64];
+}
+
+template <typename T>
+inline void futex_wait(std::atomic<T> & word, T expected)
+{
+    auto & bucket = futex_bucket_for(&word);
+    std::unique_lock<std::mutex> lock{bucket.mutex};
+    if (word.load() == expected)
+    {
+        bucket.cv.wait(lock);
+    }
+}
+
+template <typename T>
+inline void futex_wait_for(std::atomic<T> & word, T expected, std::chrono::nanoseconds timeout)
+{
+    auto & bucket = futex_bucket_for(&word);
+    std::unique_lock<std::mutex> lock{bucket.mutex};
+    if (word.load() == expected)
+    {
+        bucket.cv.wait_for(lock, timeout);
+    }
+}
+
+template <typename T>
+inline void futex_wake(std::atomic<T> & word, int = INT_MAX)
+{
+    auto & bucket = futex_bucket_for(&word);
+    {
+        std::lock_guard<std::mutex> lock{bucket.mutex};
+    }
+    bucket.cv.notify_all();
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
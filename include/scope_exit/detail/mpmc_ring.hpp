@@ -0,0 +1,201 @@
+#pragma once
+
+/// Purpose: bounded lock-free multi-producer multi-consumer ring buffer.
+///
+/// Classic sequence-numbered cell design: every cell carries a sequence counter that tells producers and consumers
+/// whether the cell is free for the current lap.  Producers and consumers each claim positions with a single CAS.
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+constexpr std::size_t cache_line_size = 64;
+
+template <typename T>
+class mpmc_ring
+{
+public:
+    /// `capacity` is rounded up to a power of two.
+    explicit mpmc_ring(std::size_t capacity)
+        : mask_{round_up(capacity) - 1}
+        , cells_{new cell[mask_ + 1]}
+    {
+        for (std::size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_ring(mpmc_ring const &) = delete;
+    mpmc_ring & operator=(mpmc_ring const &) = delete;
+
+    ~mpmc_ring()
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        for (auto pos = tail_.load(std::memory_order_relaxed); pos != head; ++pos)
+        {
+            std::launder(reinterpret_cast<T *>(cells_[pos & mask_].storage()))->~T();
+        }
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    /// Approximate number of queued elements.
+    std::size_t size() const
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+    template <typename U>
+    bool try_push(U && value)
+    {
+        auto pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell & c = cells_[pos & mask_];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    ::new (c.storage()) T(std::forward<U>(value));
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // full
+            }
+            else
+            {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Push `count` elements as one contiguous batch: either all of them are enqueued or none is.  Consumers may
+    /// start popping the first elements of a batch before the last ones are written.
+    template <typename It>
+    bool try_push_batch(It first, std::size_t count)
+    {
+        // a claimed cell cannot be given back, so filling it must not fail
+        static_assert(std::is_nothrow_move_constructible<T>::value, "batched elements must be nothrow movable");
+
+        if (count == 0)
+        {
+            return true;
+        }
+        if (count > capacity())
+        {
+            return false;
+        }
+
+        // tail is read before head so that `tail <= pos` always holds; a stale tail only underestimates the room
+        auto tail = tail_.load(std::memory_order_acquire);
+        auto pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (pos + count - tail > capacity())
+            {
+                auto fresh = tail_.load(std::memory_order_acquire);
+                if (fresh == tail)
+                {
+                    return false;  // not enough room for the whole batch
+                }
+                tail = fresh;
+                pos = head_.load(std::memory_order_relaxed);
+            }
+            else if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i != count; ++i, ++first)
+        {
+            cell & c = cells_[(pos + i) & mask_];
+            // a consumer may still be reading the previous lap of this cell
+            while (c.seq.load(std::memory_order_acquire) != pos + i)
+            {
+            }
+            ::new (c.storage()) T(std::move(*first));
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool try_pop(T & out)
+    {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell & c = cells_[pos & mask_];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    T * value = std::launder(reinterpret_cast<T *>(c.storage()));
+                    out = std::move(*value);
+                    value->~T();
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // empty, or the producer of this cell has not finished writing
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct cell
+    {
+        std::atomic<std::size_t> seq;
+        alignas(T) unsigned char data[sizeof(T)];
+
+        void * storage() { return data; }
+    };
+
+    static std::size_t round_up(std::size_t n)
+    {
+        std::size_t c = 2;
+        while (c < n)
+        {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    std::size_t const mask_;
+    std::unique_ptr<cell[]> const cells_;
+    alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+    alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+};
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,270 @@
+#pragma once
+
+/// Purpose: epoch-based read-copy-update with read-side critical sections that do no atomic read-modify-write.
+///
+/// Every thread owns a record holding the global epoch it entered its read section in (0 when outside).  Entering
+/// is a plain store of that epoch followed by a fence; on Linux the fence is only a compiler barrier, because
+/// writers force the matching full barrier on all running threads with membarrier(2).  A writer that unlinked an
+/// object bumps the epoch and waits, or defers the deletion, until no reader is left in an older epoch.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+class rcu
+{
+public:
+    /// Enter a read-side critical section.  Sections nest.
+    static void read_lock()
+    {
+        record & r = local();
+        if (r.nesting++ == 0)
+        {
+            r.epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            reader_fence();
+        }
+    }
+
+    static void read_unlock()
+    {
+        record & r = local();
+        if (--r.nesting == 0)
+        {
+            r.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /// Wait until every read section that might still see an object unlinked before the call has ended, then
+    /// reclaim retired objects.  Must not be called from inside a read section.
+    static void synchronize()
+    {
+        assert(local().nesting == 0 && "synchronize() inside a read section would never return");
+
+        auto target = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        writer_fence();
+        for (record * r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next)
+        {
+            for (;;)
+            {
+                auto e = r->epoch.load(std::memory_order_acquire);
+                if (e == 0 || e >= target)
+                {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        reclaim();
+    }
+
+    /// Delete `object` with `deleter` once no reader can still see it.  The object must already be unlinked.
+    static void retire(void * object, void (*deleter)(void *))
+    {
+        auto tag = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock{retired_.mutex};
+            retired_.items.push_back({object, deleter, tag});
+            full = retired_.items.size() >= reclaim_threshold;
+        }
+        if (full)
+        {
+            reclaim();
+        }
+    }
+
+    /// Delete the retired objects that no reader can see anymore, without waiting for anybody.
+    static void reclaim()
+    {
+        writer_fence();
+        auto oldest = std::numeric_limits<std::uint64_t>::max();
+        for (record * r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next)
+        {
+            auto e = r->epoch.load(std::memory_order_acquire);
+            if (e != 0 && e < oldest)
+            {
+                oldest = e;
+            }
+        }
+
+        std::vector<retired> ready;
+        {
+            std::lock_guard<std::mutex> lock{retired_.mutex};
+            auto safe = std::stable_partition(retired_.items.begin(), retired_.items.end(),
+                                              [oldest](retired const & r) { return r.tag > oldest; });
+            ready.assign(safe, retired_.items.end());
+            retired_.items.erase(safe, retired_.items.end());
+        }
+        for (auto const & r : ready)
+        {
+            r.deleter(r.object);
+        }
+    }
+
+    /// Number of retired objects waiting for a grace period.
+    static std::size_t pending()
+    {
+        std::lock_guard<std::mutex> lock{retired_.mutex};
+        return retired_.items.size();
+    }
+
+private:
+    static constexpr std::size_t reclaim_threshold = 64;
+
+    struct alignas(64) record
+    {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        record * next = nullptr;
+        int nesting = 0;  // touched only by the owning thread
+    };
+
+    struct retired
+    {
+        void * object;
+        void (*deleter)(void *);
+        std::uint64_t tag;
+    };
+
+    struct retired_list
+    {
+        ~retired_list()
+        {
+            for (auto const & r : items)
+            {
+                r.deleter(r.object);
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<retired> items;
+    };
+
+    // Releases the thread's record at thread exit so that a later thread can reuse it.
+    struct releaser
+    {
+        releaser()
+        {
+            std::call_once(membarrier_once_, [] { asymmetric_ = register_membarrier(); });
+
+            for (record * r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                bool free = false;
+                if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(free, true))
+                {
+                    owned = r;
+                    break;
+                }
+            }
+            if (owned == nullptr)
+            {
+                owned = new record;
+                auto * head = records_.load(std::memory_order_relaxed);
+                do
+                {
+                    owned->next = head;
+                } while (!records_.compare_exchange_weak(head, owned, std::memory_order_release));
+            }
+            local_ = owned;
+        }
+
+        ~releaser()
+        {
+            owned->epoch.store(0, std::memory_order_release);
+            owned->nesting = 0;
+            owned->in_use.store(false, std::memory_order_release);
+            local_ = nullptr;
+        }
+
+        record * owned = nullptr;
+    };
+
+    static record & local()
+    {
+        record * r = local_;
+        if (r == nullptr)
+        {
+            static thread_local releaser owner;
+            r = owner.owned;
+        }
+        return *r;
+    }
+
+    static bool register_membarrier()
+    {
+#if defined(__linux__) && defined(SYS_membarrier)
+        return ::syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#else
+        return false;
+#endif
+    }
+
+    static void reader_fence()
+    {
+        if (asymmetric_)
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+        else
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    static void writer_fence()
+    {
+        std::call_once(membarrier_once_, [] { asymmetric_ = register_membarrier(); });
+#if defined(__linux__) && defined(SYS_membarrier)
+        if (asymmetric_)
+        {
+            ::syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+            return;
+        }
+#endif
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    static inline std::atomic<std::uint64_t> epoch_{1};
+    static inline std::atomic<record *> records_{nullptr};
+    static inline retired_list retired_;
+    static inline std::once_flag membarrier_once_;
+    static inline bool asymmetric_ = false;
+    static inline thread_local record * local_ = nullptr;
+};
+
+/// Holds an rcu read-side critical section for the lifetime of the guard.
+class rcu_read_guard
+{
+public:
+    rcu_read_guard() { rcu::read_lock(); }
+
+    rcu_read_guard(rcu_read_guard const &) = delete;
+    rcu_read_guard & operator=(rcu_read_guard const &) = delete;
+
+    ~rcu_read_guard() { rcu::read_unlock(); }
+};
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,28 @@
+#pragma once
+
+/// Purpose: spread threads over the shards of a sharded counter.
+
+#include <atomic>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+// Shard a thread starts at; threads are numbered round-robin as they first ask.  Callers may store the shard they
+// ended up using so that the next call starts there.
+inline unsigned & thread_shard_hint()
+{
+    static std::atomic<unsigned> next{0};
+    static thread_local unsigned hint = next.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
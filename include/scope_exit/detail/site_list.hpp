@@ -0,0 +1,78 @@
+#pragma once
+
+/// Purpose: registry of the statically allocated sites of an instrumented guard kind.
+///
+/// Sites are function-local statics with constexpr constructors.  A site adds itself to the list of its type the
+/// first time it is entered; the list is never shrunk, so it can be walked at any time without locking.
+
+#include <atomic>
+#include <cstdint>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+/// `Site` needs `std::atomic<bool> registered_` and `Site * next_` members accessible to `site_list<Site>`.
+template <typename Site>
+class site_list
+{
+public:
+    static void add(Site & site)
+    {
+        if (site.registered_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        bool expected = false;
+        if (site.registered_.compare_exchange_strong(expected, true, std::memory_order_relaxed))
+        {
+            auto & sites = head();
+            site.next_ = sites.load(std::memory_order_relaxed);
+            while (!sites.compare_exchange_weak(site.next_, &site, std::memory_order_release,
+                                                std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    /// Call `f(site)` for every registered site, most recently registered first.
+    template <typename F>
+    static void for_each(F && f)
+    {
+        for (Site * s = head().load(std::memory_order_acquire); s != nullptr; s = s->next_)
+        {
+            f(*s);
+        }
+    }
+
+private:
+    static std::atomic<Site *> & head()
+    {
+        static std::atomic<Site *> sites{nullptr};
+        return sites;
+    }
+};
+
+/// True on every `period`-th call on the calling thread, counted separately for each `Tag`.
+template <typename Tag>
+inline bool sample_tick(std::atomic<std::uint32_t> const & period)
+{
+    static thread_local std::uint32_t countdown = 1;
+    if (--countdown != 0)
+    {
+        return false;
+    }
+    countdown = period.load(std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace detail
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,235 @@
+#pragma once
+
+/// Purpose: count in-flight requests with scope guards and wait for them to finish before shutting down.
+///
+/// `inflight_tracker::enter()` returns an `inflight_guard` that counts the request as in flight until it is
+/// destroyed.  The counts are kept in cache-line sized shards, one per hardware thread, so requests entering and
+/// leaving on different threads do not contend on one cache line.  A guard leaves through the shard it entered on.
+///
+/// `drain()` stops admitting requests: from then on `enter()` returns an empty guard.  It then sleeps on a futex until
+/// every admitted request has left.  Leaving requests only wake the drainer when their shard drops to zero, so a drain
+/// over many requests costs a handful of wakeups rather than one per request.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::inflight_tracker inflight;
+///
+///   void handle(request & r)
+///   {
+///       auto admitted = inflight.enter();
+///       if (!admitted)
+///       {
+///           return r.reply(503);  // shutting down
+///       }
+///       r.reply(process(r));
+///   }
+///
+///   void shutdown()
+///   {
+///       if (!inflight.drain_for(std::chrono::seconds{30}))
+///       {
+///           log("giving up on ", inflight.in_flight(), " requests");
+///       }
+///   }
+/// ```
+
+#include <scope_exit/detail/futex.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+#include <scope_exit/detail/shard_hint.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+class inflight_tracker;
+
+/// Counts one request as in flight for its lifetime.  Empty if the tracker was draining.
+class inflight_guard
+{
+public:
+    inflight_guard() = default;
+
+    inflight_guard(inflight_guard && other) noexcept
+        : tracker_{std::exchange(other.tracker_, nullptr)}
+        , shard_{other.shard_}
+    {}
+
+    inflight_guard & operator=(inflight_guard && other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            tracker_ = std::exchange(other.tracker_, nullptr);
+            shard_ = other.shard_;
+        }
+        return *this;
+    }
+
+    ~inflight_guard() { release(); }
+
+    /// True if the request was admitted.
+    explicit operator bool() const { return tracker_ != nullptr; }
+
+    /// Leave early.
+    inline void release();
+
+private:
+    friend class inflight_tracker;
+
+    inflight_guard(inflight_tracker * tracker, unsigned shard)
+        : tracker_{tracker}
+        , shard_{shard}
+    {}
+
+    inflight_tracker * tracker_ = nullptr;
+    unsigned shard_ = 0;
+};
+
+class inflight_tracker
+{
+public:
+    /// Maximum number of shards.
+    static constexpr unsigned max_shards = 64;
+
+    /// `shards` defaults to the number of hardware threads, at most `max_shards`.
+    explicit inflight_tracker(unsigned shards = default_shards())
+        : shard_count_{std::clamp(shards, 1u, max_shards)}
+        , shards_{new shard[shard_count_]}
+    {}
+
+    inflight_tracker(inflight_tracker const &) = delete;
+    inflight_tracker & operator=(inflight_tracker const &) = delete;
+
+    /// Admit a request unless the tracker is draining.
+    inflight_guard enter()
+    {
+        unsigned const hint = detail::thread_shard_hint();
+        unsigned const s = hint < shard_count_ ? hint : hint % shard_count_;
+
+        // pairs with drain(): either the drainer counts this request or we see that it is draining
+        shards_[s].count.fetch_add(1, std::memory_order_seq_cst);
+        if (draining_.load(std::memory_order_seq_cst))
+        {
+            leave(s);
+            return inflight_guard{};
+        }
+        return inflight_guard{this, s};
+    }
+
+    /// Stop admitting requests and wait until every admitted one has left.
+    void drain() { drain_until(std::chrono::steady_clock::time_point::max()); }
+
+    /// Stop admitting requests and wait up to `timeout` for the admitted ones to leave.  Returns true if none is left.
+    template <typename Rep, typename Period>
+    bool drain_for(std::chrono::duration<Rep, Period> timeout)
+    {
+        return drain_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    /// Admit requests again after a drain.
+    void reopen() { draining_.store(false, std::memory_order_seq_cst); }
+
+    bool draining() const { return draining_.load(std::memory_order_relaxed); }
+
+    /// Number of admitted requests that have not left yet.  Exact only while no request enters or leaves.
+    std::int64_t in_flight() const
+    {
+        std::int64_t sum = 0;
+        for (unsigned i = 0; i != shard_count_; ++i)
+        {
+            sum += shards_[i].count.load(std::memory_order_seq_cst);
+        }
+        return sum;
+    }
+
+    static unsigned default_shards()
+    {
+        static unsigned const n = std::max(1u, std::thread::hardware_concurrency());
+        return n;
+    }
+
+private:
+    friend class inflight_guard;
+
+    struct alignas(detail::cache_line_size) shard
+    {
+        std::atomic<std::int64_t> count{0};
+    };
+
+    // Requests that left before seeing the drain start cannot wake the drainer, so its sleeps are capped at
+    // `recheck`.  The ones that see it register in `wakers_` and the drainer waits for them, so the tracker can be
+    // destroyed as soon as a drain has returned true.
+    static constexpr std::chrono::milliseconds recheck{1};
+
+    bool drain_until(std::chrono::steady_clock::time_point deadline)
+    {
+        draining_.store(true, std::memory_order_seq_cst);
+        for (;;)
+        {
+            auto w = wakeups_.load(std::memory_order_seq_cst);
+            if (in_flight() == 0)
+            {
+                while (wakers_.load(std::memory_order_acquire) != 0)
+                {
+                    std::this_thread::yield();
+                }
+                return true;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                return false;
+            }
+            detail::futex_wait_for(wakeups_, w, std::min<std::chrono::steady_clock::duration>(deadline - now, recheck));
+        }
+    }
+
+    void leave(unsigned s)
+    {
+        auto & count = shards_[s].count;
+        if (!draining_.load(std::memory_order_seq_cst))
+        {
+            count.fetch_sub(1, std::memory_order_seq_cst);
+            return;
+        }
+
+        // the total can only reach zero when some shard does, so only those leaves wake the drainer
+        wakers_.fetch_add(1, std::memory_order_seq_cst);
+        if (count.fetch_sub(1, std::memory_order_seq_cst) == 1)
+        {
+            wakeups_.fetch_add(1, std::memory_order_seq_cst);
+            detail::futex_wake(wakeups_);
+        }
+        wakers_.fetch_sub(1, std::memory_order_release);
+    }
+
+    unsigned const shard_count_;
+    std::unique_ptr<shard[]> const shards_;
+    alignas(detail::cache_line_size) std::atomic<bool> draining_{false};
+    std::atomic<std::uint32_t> wakeups_{0};
+    std::atomic<std::uint32_t> wakers_{0};  // leaving requests that may still wake the drainer
+};
+
+inline void inflight_guard::release()
+{
+    if (auto * tracker = std::exchange(tracker_, nullptr))
+    {
+        tracker->leave(shard_);
+    }
+}
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
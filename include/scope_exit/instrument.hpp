@@ -0,0 +1,395 @@
+#pragma once
+
+/// Purpose: per-site statistics for guarded scopes, for sizing pools and finding hot spots.
+///
+/// Every guard macro use is a site, identified by its file, line and the `__COUNTER__` value the macro already uses
+/// to name its guard object.  When `SCOPE_EXIT_INSTRUMENT` is defined before scope_exit.hpp is included,
+/// `scope(exit)`, `scope(success)` and `scope(failure)` put a probe in front of their guard that counts how many
+/// threads are inside the guarded region: from the guard statement to the end of the enclosing scope, including the
+/// guard's action.  The probe records the number of entries, the current number of threads inside and the highest
+/// number seen (the high-water mark).
+///
+/// Entries and the active count are kept in cache-line sized shards, so threads entering the same site rarely share
+/// a cache line.  Computing the high-water mark means summing the shards, which each thread does on every n-th entry
+/// only, n being the sample period (`SCOPE_EXIT_INSTRUMENT_SAMPLE`, default 1, or `instrument::set_sample_period`).
+/// With a period above 1 the mark can miss short peaks.  The sum is not an atomic snapshot, so under heavy churn the
+/// mark is approximate in both directions.
+///
+/// Defining `SCOPE_EXIT_INSTRUMENT_DEPTH` (which implies `SCOPE_EXIT_INSTRUMENT`) also tracks how deeply instrumented
+/// guards nest on each thread.  Every entry records its depth, 1 for the outermost guard of a thread, into a per-site
+/// histogram and maximum, together with the distance in bytes between the outermost probe on the thread's stack and
+/// this one: an estimate of the stack the nested calls use, assuming the stack grows down.  This costs a thread-local
+/// update and one more read-modify-write per entry.  The macro changes the layout of the sites, so the site, probe
+/// and registry types live in an inline namespace named after it: translation units that disagree on it do not share
+/// definitions (which would be an undiagnosed ODR violation) but keep separate registries, each reporting only the
+/// sites compiled its way.  Define the macro the same way in every translation unit to get a single report.
+///
+/// Example:
+/// ```
+///   #define SCOPE_EXIT_INSTRUMENT
+///   #include <scope_exit/scope_exit.hpp>
+///
+///   void query(connection_pool & pool)
+///   {
+///       auto c = pool.acquire();
+///       scope(exit) { pool.release(c); };  // peak of this site = connections needed
+///       c.run();
+///   }
+///
+///   int main()
+///   {
+///       serve();
+///       scope_exit_v1::instrument::report(stderr);
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+#include <scope_exit/detail/shard_hint.hpp>
+#include <scope_exit/detail/site_list.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if !defined(SCOPE_EXIT_INSTRUMENT_SAMPLE)
+#define SCOPE_EXIT_INSTRUMENT_SAMPLE 1
+#endif
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+/// Instrumented guards alive on the calling thread.
+struct guard_nesting
+{
+    std::uint32_t depth = 0;
+    std::uintptr_t outermost = 0;  // address of the outermost probe
+};
+
+inline guard_nesting & thread_nesting()
+{
+    thread_local guard_nesting nesting;
+    return nesting;
+}
+
+}  // namespace detail
+
+/// Entries per nesting depth: bucket b holds depths [2^b, 2^(b+1)); the last bucket holds everything above.
+using depth_histogram = std::array<std::uint64_t, 16>;
+
+/// Statistics of one site at the time `instrument::sites()` was called.
+struct site_stats
+{
+    char const * file;
+    int line;
+    unsigned id;        // `__COUNTER__` value of the macro use
+    char const * kind;  // "exit", "success", "failure"
+    std::uint64_t entries;
+    std::int64_t active;
+    std::int64_t peak;
+
+    // filled with SCOPE_EXIT_INSTRUMENT_DEPTH, zero otherwise
+    std::uint32_t max_depth;  // deepest nesting of instrumented guards seen at this site
+    std::uint64_t max_stack;  // largest distance in bytes from the thread's outermost probe
+    depth_histogram depth;
+};
+
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+inline namespace instrument_depth
+#else
+inline namespace instrument_basic
+#endif
+{
+
+/// Counters of one guard site.  Sites are function-local statics created by the guard macros; their constructor is
+/// constexpr, so they need no dynamic initialization and cost nothing until the site is first entered.
+class instrument_site
+{
+public:
+    static constexpr unsigned shards = 8;
+
+    constexpr instrument_site(char const * file, int line, unsigned id, char const * kind)
+        : file_{file}
+        , line_{line}
+        , id_{id}
+        , kind_{kind}
+    {}
+
+    instrument_site(instrument_site const &) = delete;
+    instrument_site & operator=(instrument_site const &) = delete;
+
+    /// Count the calling thread in.  Returns the shard to pass to `leave()`.
+    inline unsigned enter();
+
+    void leave(unsigned shard) { shards_[shard].word.fetch_sub(1, std::memory_order_relaxed); }
+
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+    /// Record an entry at nesting `depth` that is `stack` bytes below the thread's outermost probe.
+    void record_depth(unsigned shard, std::uint32_t depth, std::uint64_t stack)
+    {
+        shards_[shard].depth[depth_bucket(depth)].fetch_add(1, std::memory_order_relaxed);
+        raise(max_depth_, depth);
+        raise(max_stack_, stack);
+    }
+#endif
+
+    inline site_stats stats() const;
+
+    void reset()
+    {
+        for (auto & s : shards_)
+        {
+            s.word.fetch_and(active_mask, std::memory_order_relaxed);
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+            for (auto & d : s.depth)
+            {
+                d.store(0, std::memory_order_relaxed);
+            }
+#endif
+        }
+        peak_.store(0, std::memory_order_relaxed);
+        max_depth_.store(0, std::memory_order_relaxed);
+        max_stack_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    friend class detail::site_list<instrument_site>;
+
+    // Entering and leaving is one read-modify-write each: a shard word holds the entries in its upper bits and the
+    // threads inside in its lower `active_bits`.
+    static constexpr unsigned active_bits = 24;
+    static constexpr std::uint64_t active_mask = (std::uint64_t{1} << active_bits) - 1;
+
+    static constexpr std::size_t depth_buckets = std::tuple_size<depth_histogram>::value;
+
+    struct alignas(detail::cache_line_size) shard
+    {
+        std::atomic<std::uint64_t> word{0};
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+        std::atomic<std::uint64_t> depth[depth_buckets] = {};
+#endif
+    };
+
+    static std::size_t depth_bucket(std::uint32_t depth)
+    {
+        std::size_t b = 0;
+#if defined(__GNUC__) || defined(__clang__)
+        b = 31 - static_cast<std::size_t>(__builtin_clz(depth | 1));
+#else
+        for (; depth > 1; depth >>= 1)
+        {
+            ++b;
+        }
+#endif
+        return std::min(b, depth_buckets - 1);
+    }
+
+    template <typename T>
+    static void raise(std::atomic<T> & max, T value)
+    {
+        auto current = max.load(std::memory_order_relaxed);
+        while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    std::int64_t active() const
+    {
+        std::int64_t sum = 0;
+        for (auto const & s : shards_)
+        {
+            sum += static_cast<std::int64_t>(s.word.load(std::memory_order_seq_cst) & active_mask);
+        }
+        return sum;
+    }
+
+    void update_peak() { raise(peak_, active()); }
+
+    char const * file_;
+    int line_;
+    unsigned id_;
+    char const * kind_;
+    std::atomic<bool> registered_{false};
+    instrument_site * next_ = nullptr;
+    std::atomic<std::int64_t> peak_{0};
+    std::atomic<std::uint32_t> max_depth_{0};
+    std::atomic<std::uint64_t> max_stack_{0};
+    shard shards_[shards];
+};
+
+/// Registry of the sites entered so far.
+class instrument
+{
+public:
+    /// Snapshot of every site entered so far, most recently registered first.
+    static std::vector<site_stats> sites()
+    {
+        std::vector<site_stats> result;
+        detail::site_list<instrument_site>::for_each([&](instrument_site const & s) { result.push_back(s.stats()); });
+        return result;
+    }
+
+    /// Print one line per site, highest peak first.
+    static void report(std::FILE * out)
+    {
+        auto all = sites();
+        std::sort(all.begin(), all.end(), [](site_stats const & a, site_stats const & b) { return a.peak > b.peak; });
+        std::fprintf(out, "%-40s %6s %-8s %14s %8s %8s", "site", "id", "kind", "entries", "active", "peak");
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+        std::fprintf(out, " %9s %10s", "max depth", "stack B");
+#endif
+        std::fprintf(out, "\n");
+        for (auto const & s : all)
+        {
+            char where[256];
+            std::snprintf(where, sizeof where, "%s:%d", s.file, s.line);
+            std::fprintf(out, "%-40s %6u %-8s %14llu %8lld %8lld", where, s.id, s.kind,
+                         static_cast<unsigned long long>(s.entries), static_cast<long long>(s.active),
+                         static_cast<long long>(s.peak));
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+            std::fprintf(out, " %9u %10llu", s.max_depth, static_cast<unsigned long long>(s.max_stack));
+#endif
+            std::fprintf(out, "\n");
+        }
+    }
+
+    /// Zero the entry counts, high-water marks and depth statistics of every site.  Threads inside a site stay counted
+    /// as active.
+    static void reset()
+    {
+        detail::site_list<instrument_site>::for_each([](instrument_site & s) { s.reset(); });
+    }
+
+    /// Update the high-water mark on every `period`-th entry of each thread.  Takes effect on a thread's next update.
+    static void set_sample_period(std::uint32_t period)
+    {
+        sample_period().store(std::max<std::uint32_t>(1, period), std::memory_order_relaxed);
+    }
+
+private:
+    friend class instrument_site;
+
+    static std::atomic<std::uint32_t> & sample_period()
+    {
+        static std::atomic<std::uint32_t> period{SCOPE_EXIT_INSTRUMENT_SAMPLE};
+        return period;
+    }
+};
+
+inline unsigned instrument_site::enter()
+{
+    detail::site_list<instrument_site>::add(*this);
+
+    unsigned const s = detail::thread_shard_hint() % shards;
+    shards_[s].word.fetch_add((std::uint64_t{1} << active_bits) + 1, std::memory_order_seq_cst);
+    if (detail::sample_tick<instrument>(instrument::sample_period()))
+    {
+        update_peak();
+    }
+    return s;
+}
+
+inline site_stats instrument_site::stats() const
+{
+    site_stats r{file_,
+                 line_,
+                 id_,
+                 kind_,
+                 0,
+                 active(),
+                 peak_.load(std::memory_order_relaxed),
+                 max_depth_.load(std::memory_order_relaxed),
+                 max_stack_.load(std::memory_order_relaxed),
+                 {}};
+    for (auto const & s : shards_)
+    {
+        r.entries += s.word.load(std::memory_order_relaxed) >> active_bits;
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+        for (std::size_t b = 0; b != depth_buckets; ++b)
+        {
+            r.depth[b] += s.depth[b].load(std::memory_order_relaxed);
+        }
+#endif
+    }
+    return r;
+}
+
+/// Counts the calling thread as inside the site returned by `get_site()` for the lifetime of the probe.  During
+/// constant evaluation (C++20 constexpr guards) the probe neither looks up the site nor counts anything.
+class instrument_probe
+{
+public:
+    template <typename GetSite>
+    SCOPE_CONSTEXPR20_ explicit instrument_probe(GetSite get_site)
+    {
+        if (!detail::is_constant_evaluated())
+        {
+            enter(get_site());
+        }
+    }
+
+    instrument_probe(instrument_probe const &) = delete;
+    instrument_probe & operator=(instrument_probe const &) = delete;
+
+    SCOPE_CONSTEXPR20_ ~instrument_probe()
+    {
+        if (!detail::is_constant_evaluated())
+        {
+            leave();
+        }
+    }
+
+private:
+    void enter(instrument_site & site)
+    {
+        site_ = &site;
+        shard_ = site.enter();
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+        // the probe lives in the frame of the function holding the guard, so its address stands in for the stack
+        // pointer there
+        auto & nesting = detail::thread_nesting();
+        auto const here = reinterpret_cast<std::uintptr_t>(this);
+        if (nesting.depth++ == 0)
+        {
+            nesting.outermost = here;
+        }
+        site.record_depth(shard_, nesting.depth, nesting.outermost > here ? nesting.outermost - here : 0);
+#endif
+    }
+
+    void leave()
+    {
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH)
+        --detail::thread_nesting().depth;
+#endif
+        site_->leave(shard_);
+    }
+
+    instrument_site * site_ = nullptr;
+    unsigned shard_ = 0;
+};
+
+}  // namespace instrument_depth or instrument_basic
+}  // namespace scope_exit_v1
+
+// Declares the site and probe for guard `id`; used by the guard macros in scope_exit.hpp.  The site is a static of
+// a lambda rather than of the enclosing function, which a constexpr function could not declare before C++23.
+#define SCOPE_INSTRUMENT_PROBE_(kind, id)                                                                              \
+    scope_exit_v1::instrument_probe const SCOPE_CONCAT_(scope_probe_, id)                                              \
+    {                                                                                                                  \
+        []() -> scope_exit_v1::instrument_site & {                                                                     \
+            static scope_exit_v1::instrument_site site(__FILE__, __LINE__, id, #kind);                                 \
+            return site;                                                                                               \
+        }                                                                                                              \
+    }
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
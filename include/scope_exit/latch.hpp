@@ -0,0 +1,243 @@
+#pragma once
+
+/// Purpose: wait for a fan-out of subtasks that count down a latch when their scope exits.
+///
+/// `completion_latch` splits its count over cache-line sized shards, one per hardware thread.  A thread counts down
+/// the shard it last used, so concurrent subtasks rarely touch the same cache line.  When a shard runs out the thread
+/// moves on to the next one, and the thread that empties the last shard wakes every waiter with a single futex call.
+/// Count-downs before that never touch the word waiters sleep on.
+///
+/// `scope(count_down, latch)` counts down when the scope exits.  If it exits through an exception, the latch also
+/// records a failure, so the waiting thread can tell whether every subtask succeeded.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::completion_latch done{parts.size()};
+///   for (auto & p : parts)
+///   {
+///       pool.submit([&] {
+///           scope(count_down, done);
+///           process(p);
+///       });
+///   }
+///   done.wait();
+///   if (done.failures() != 0) { /* some parts were not processed */ }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/detail/futex.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+#include <scope_exit/detail/shard_hint.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace scope_exit_v1
+{
+
+class completion_latch
+{
+public:
+    /// Maximum number of shards.
+    static constexpr unsigned max_shards = 64;
+
+    /// `shards` defaults to the number of hardware threads, at most `max_shards`; there are never more shards than
+    /// the count.
+    explicit completion_latch(std::size_t count, unsigned shards = default_shards())
+        : shard_count_{static_cast<unsigned>(std::min<std::size_t>(count, std::clamp(shards, 1u, max_shards)))}
+        , shards_{new shard[shard_count_]}
+        , pending_{shard_count_}
+    {
+        for (unsigned i = 0; i != shard_count_; ++i)
+        {
+            auto share = count * (i + 1) / shard_count_ - count * i / shard_count_;
+            shards_[i].remaining.store(static_cast<std::int64_t>(share), std::memory_order_relaxed);
+        }
+    }
+
+    completion_latch(completion_latch const &) = delete;
+    completion_latch & operator=(completion_latch const &) = delete;
+
+    /// Count down by `n`.  Counting down more than the initial count is a precondition violation, except that on a
+    /// latch created with a zero count, which has no shards, it does nothing.
+    void count_down(std::size_t n = 1)
+    {
+        if (shard_count_ == 0)
+        {
+            return;
+        }
+
+        unsigned & hint = detail::thread_shard_hint();
+        unsigned s = hint < shard_count_ ? hint : hint % shard_count_;
+        if (n == 1)
+        {
+            // an empty shard just goes negative; it is skipped from then on
+            for (unsigned k = 0; k != shard_count_; ++k, s = s + 1 != shard_count_ ? s + 1 : 0)
+            {
+                auto r = shards_[s].remaining.fetch_sub(1, std::memory_order_acq_rel);
+                if (r > 0)
+                {
+                    hint = s;
+                    if (r == 1)
+                    {
+                        finish_shard();
+                    }
+                    return;
+                }
+            }
+            assert(false && "completion_latch counted down below zero");
+            return;
+        }
+
+        auto left = static_cast<std::int64_t>(n);
+        for (unsigned k = 0; left != 0 && k != shard_count_; ++k, s = s + 1 != shard_count_ ? s + 1 : 0)
+        {
+            auto & remaining = shards_[s].remaining;
+            auto r = remaining.load(std::memory_order_relaxed);
+            while (r > 0)
+            {
+                auto take = std::min(r, left);
+                if (remaining.compare_exchange_weak(r, r - take, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    left -= take;
+                    hint = s;
+                    if (r == take)
+                    {
+                        finish_shard();
+                    }
+                    if (left == 0)
+                    {
+                        return;  // the latch may be gone already: no more access to members
+                    }
+                    break;
+                }
+            }
+        }
+        assert(left == 0 && "completion_latch counted down below zero");
+    }
+
+    /// Count down by one and record a failed subtask.
+    void count_down_failed()
+    {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        count_down();
+    }
+
+    /// True once the count has reached zero.
+    bool try_wait() const { return (pending_.load(std::memory_order_acquire) & ~waiting) == 0; }
+
+    /// Block until the count reaches zero.
+    void wait() const
+    {
+        if (try_wait())
+        {
+            return;
+        }
+        for (auto p = pending_.fetch_or(waiting, std::memory_order_acquire) | waiting; p != waiting;
+             p = pending_.load(std::memory_order_acquire))
+        {
+            detail::futex_wait(pending_, p);
+        }
+    }
+
+    /// Block until the count reaches zero or `timeout` passes.  Returns `try_wait()`.
+    template <typename Rep, typename Period>
+    bool wait_for(std::chrono::duration<Rep, Period> timeout) const
+    {
+        if (try_wait())
+        {
+            return true;
+        }
+        auto const deadline = std::chrono::steady_clock::now() + timeout;
+        for (auto p = pending_.fetch_or(waiting, std::memory_order_acquire) | waiting; p != waiting;
+             p = pending_.load(std::memory_order_acquire))
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                return false;
+            }
+            detail::futex_wait_for(pending_, p, deadline - now);
+        }
+        return true;
+    }
+
+    /// Number of count-downs that happened during exception unwinding.  Complete once `try_wait()` is true.
+    std::uint32_t failures() const { return failures_.load(std::memory_order_acquire); }
+
+    static unsigned default_shards()
+    {
+        static unsigned const n = std::max(1u, std::thread::hardware_concurrency());
+        return n;
+    }
+
+private:
+    static constexpr std::uint32_t waiting = 1u << 31;
+
+    struct alignas(detail::cache_line_size) shard
+    {
+        std::atomic<std::int64_t> remaining{0};  // <= 0 once empty
+    };
+
+    // The latch may be destroyed as soon as a waiter sees the last shard finish, so this is the last access to it.
+    void finish_shard()
+    {
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == (waiting | 1))
+        {
+            detail::futex_wake(pending_);
+        }
+    }
+
+    unsigned const shard_count_;
+    std::unique_ptr<shard[]> const shards_;
+    // shards not yet empty, plus `waiting` once a thread has blocked in wait()
+    alignas(detail::cache_line_size) mutable std::atomic<std::uint32_t> pending_;
+    std::atomic<std::uint32_t> failures_{0};
+};
+
+/// Counts down a latch when the scope exits; during exception unwinding the count-down is recorded as a failure.
+class count_down_guard
+{
+public:
+    explicit count_down_guard(completion_latch & latch)
+        : latch_{latch}
+        , uncaught_count_{std::uncaught_exceptions()}
+    {}
+
+    count_down_guard(count_down_guard const &) = delete;
+    count_down_guard & operator=(count_down_guard const &) = delete;
+
+    ~count_down_guard()
+    {
+        if (std::uncaught_exceptions() > uncaught_count_)
+        {
+            latch_.count_down_failed();
+        }
+        else
+        {
+            latch_.count_down();
+        }
+    }
+
+private:
+    completion_latch & latch_;
+    int uncaught_count_;
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_count_down(latch)                                                                                        \
+    [[maybe_unused]] scope_exit_v1::count_down_guard const SCOPE_CONCAT_(scope_count_down_obj_, __COUNTER__){latch}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,291 @@
+#pragma once
+
+/// Purpose: request-scoped memoization that needs no invalidation.
+///
+/// A `memo_scope` is an open-addressing hash table allocated from a per-thread arena.  While it is alive it is the
+/// calling thread's current scope for its key/value types, reachable through `memo_scope::current()` or the
+/// `memoize()` helper.  Lookups fall through to enclosing scopes, so inner scopes see outer entries; new entries go
+/// to the innermost scope.  On scope exit the whole table is dropped in O(1) by rewinding the arena (entries with
+/// non-trivial destructors are destroyed first).
+///
+/// Example:
+/// ```
+///   void handle(request const & r)
+///   {
+///       scope_exit_v1::memo_scope<user_id, permissions> memo;
+///       for (auto const & item : r.items())
+///       {
+///           auto perms = scope_exit_v1::memoize<user_id, permissions>(item.owner, load_permissions);
+///       }
+///   }
+/// ```
+
+#include <scope_exit/detail/arena.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class memo_scope
+{
+public:
+    explicit memo_scope(std::size_t expected_entries = 32)
+        : parent_{current_}
+        , mark_{arena_.save()}
+    {
+        std::size_t capacity = 8;
+        while (capacity * 3 < expected_entries * 4)
+        {
+            capacity *= 2;
+        }
+        slots_ = allocate_slots(capacity);
+        mask_ = capacity - 1;
+        current_ = this;
+    }
+
+    memo_scope(memo_scope const &) = delete;
+    memo_scope & operator=(memo_scope const &) = delete;
+
+    ~memo_scope()
+    {
+        destroy_entries(slots_, mask_ + 1);
+        arena_.rewind(mark_);
+        current_ = parent_;
+    }
+
+    /// The calling thread's innermost scope for these types, or nullptr.
+    static memo_scope * current() { return current_; }
+
+    memo_scope * parent() const { return parent_; }
+
+    /// Look the key up in this scope and then in the enclosing ones.
+    Value const * find(Key const & key) const
+    {
+        auto h = hash_of(key);
+        for (memo_scope const * s = this; s != nullptr; s = s->parent_)
+        {
+            if (Value const * v = s->find_local(key, h))
+            {
+                return v;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Return the cached value for `key`, computing and caching `compute(key)` on a miss.  Like `insert()`, the
+    /// returned reference stays valid until the next insertion into this scope.
+    template <typename Compute>
+    Value const & get_or_compute(Key const & key, Compute && compute)
+    {
+        auto h = hash_of(key);
+        for (memo_scope const * s = this; s != nullptr; s = s->parent_)
+        {
+            if (Value const * v = s->find_local(key, h))
+            {
+                ++hits_;
+                return *v;
+            }
+        }
+
+        ++misses_;
+        require_innermost();
+        return emplace(h, key, std::forward<Compute>(compute)(key));
+    }
+
+    /// Cache a value in this scope.  Only the innermost scope may insert, since enclosing scopes cannot grow their
+    /// part of the arena while an inner scope holds the top of it; inserting into an enclosing scope throws
+    /// `std::logic_error`, and so does a miss in its `get_or_compute()`.
+    Value const & insert(Key const & key, Value value)
+    {
+        auto h = hash_of(key);
+        if (Value const * v = find_local(key, h))
+        {
+            return *v;
+        }
+        require_innermost();
+        return emplace(h, key, std::move(value));
+    }
+
+    /// Entries in this scope, not counting enclosing scopes.
+    std::size_t size() const { return size_; }
+
+    std::size_t hits() const { return hits_; }
+    std::size_t misses() const { return misses_; }
+
+private:
+    struct slot
+    {
+        std::size_t hash;  // 0 marks an empty slot
+        alignas(Key) unsigned char key[sizeof(Key)];
+        alignas(Value) unsigned char value[sizeof(Value)];
+
+        Key const & k() const { return *std::launder(reinterpret_cast<Key const *>(key)); }
+        Value const & v() const { return *std::launder(reinterpret_cast<Value const *>(value)); }
+        Key & k() { return *std::launder(reinterpret_cast<Key *>(key)); }
+        Value & v() { return *std::launder(reinterpret_cast<Value *>(value)); }
+    };
+
+    static constexpr bool trivial_entries =
+        std::is_trivially_destructible<Key>::value && std::is_trivially_destructible<Value>::value;
+
+    static std::size_t hash_of(Key const & key)
+    {
+        std::size_t h = Hash{}(key);
+        // mix the bits so that identity hashes spread over the table, and keep 0 for empty slots
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h | 1;
+    }
+
+    static slot * allocate_slots(std::size_t capacity)
+    {
+        auto * slots = static_cast<slot *>(arena_.allocate(capacity * sizeof(slot), alignof(slot)));
+        for (std::size_t i = 0; i != capacity; ++i)
+        {
+            slots[i].hash = 0;
+        }
+        return slots;
+    }
+
+    static void destroy_entries(slot * slots, std::size_t capacity)
+    {
+        if constexpr (!trivial_entries)
+        {
+            for (std::size_t i = 0; i != capacity; ++i)
+            {
+                if (slots[i].hash != 0)
+                {
+                    slots[i].k().~Key();
+                    slots[i].v().~Value();
+                }
+            }
+        }
+    }
+
+    Value const * find_local(Key const & key, std::size_t h) const
+    {
+        for (std::size_t i = h & mask_;; i = (i + 1) & mask_)
+        {
+            slot const & s = slots_[i];
+            if (s.hash == 0)
+            {
+                return nullptr;
+            }
+            if (s.hash == h && KeyEqual{}(s.k(), key))
+            {
+                return &s.v();
+            }
+        }
+    }
+
+    // A table grown while an inner scope is open would be carved from the inner scope's part of the arena and freed
+    // by its rewind.
+    void require_innermost() const
+    {
+        if (current_ != this)
+        {
+            throw std::logic_error("memo_scope: only the innermost scope may insert");
+        }
+    }
+
+    template <typename V>
+    Value const & emplace(std::size_t h, Key const & key, V && value)
+    {
+        if ((size_ + 1) * 4 > (mask_ + 1) * 3)
+        {
+            grow();
+        }
+
+        std::size_t i = h & mask_;
+        while (slots_[i].hash != 0)
+        {
+            i = (i + 1) & mask_;
+        }
+
+        slot & s = slots_[i];
+        ::new (s.key) Key(key);
+        try
+        {
+            ::new (s.value) Value(std::forward<V>(value));
+        }
+        catch (...)
+        {
+            s.k().~Key();
+            throw;
+        }
+        s.hash = h;
+        ++size_;
+        return s.v();
+    }
+
+    // The old table stays in the arena until the scope exits.
+    void grow()
+    {
+        std::size_t capacity = (mask_ + 1) * 2;
+        slot * slots = allocate_slots(capacity);
+        for (std::size_t i = 0; i <= mask_; ++i)
+        {
+            slot & from = slots_[i];
+            if (from.hash != 0)
+            {
+                std::size_t j = from.hash & (capacity - 1);
+                while (slots[j].hash != 0)
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                ::new (slots[j].key) Key(std::move(from.k()));
+                ::new (slots[j].value) Value(std::move(from.v()));
+                slots[j].hash = from.hash;
+            }
+        }
+
+        destroy_entries(slots_, mask_ + 1);
+        slots_ = slots;
+        mask_ = capacity - 1;
+    }
+
+    static thread_local detail::arena arena_;
+    static thread_local memo_scope * current_;
+
+    memo_scope * parent_;
+    detail::arena::position mark_;
+    slot * slots_ = nullptr;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+thread_local detail::arena memo_scope<Key, Value, Hash, KeyEqual>::arena_;
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+thread_local memo_scope<Key, Value, Hash, KeyEqual> * memo_scope<Key, Value, Hash, KeyEqual>::current_ = nullptr;
+
+/// Memoize `compute(key)` in the calling thread's current scope, or just compute it if there is none.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+          typename Compute>
+Value memoize(Key const & key, Compute && compute)
+{
+    if (auto * memo = memo_scope<Key, Value, Hash, KeyEqual>::current())
+    {
+        return memo->get_or_compute(key, std::forward<Compute>(compute));
+    }
+    return std::forward<Compute>(compute)(key);
+}
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,386 @@
+#pragma once
+
+/// Purpose: in-memory multi-version key-value store where a scope's writes become visible together on success.
+///
+/// The store is a chain of immutable versions reachable from an atomic head pointer.  A `write_scope` buffers its
+/// writes; when the scope exits normally they are published as a new version with a single compare-and-swap of the
+/// head, and when it exits through an exception they are dropped.  Small write sets are published as a delta on top
+/// of the previous version; every `max_chain` deltas, or for large write sets, the committer folds the chain into a
+/// fresh full version.  A `read_scope` pins the current version, so all lookups through it see one consistent
+/// snapshot.  Replaced versions are reclaimed through epoch-based RCU once no read scope can see them.  Folding copies
+/// the whole map, so the store is meant for small, read-mostly data such as routing tables or feature settings.
+///
+/// A write scope also pins the version current when it opens, and its `find` reads that snapshot.  Commits are
+/// optimistic: a commit first checks that no key the scope read through the snapshot has been written since, and if
+/// one has, the first committer wins and the scope's destructor throws `mvcc_conflict` without publishing anything.
+/// `update()` reruns a transaction until it commits.  Keys that are only written are not checked, so blind writes of
+/// the same key from concurrent scopes still resolve as last writer wins.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::mvcc_store<std::string, std::int64_t> accounts;
+///
+///   void transfer(std::string const & from, std::string const & to, std::int64_t amount)
+///   {
+///       accounts.update([&](auto & tx) {
+///           tx.put(from, *tx.find(from) - amount);
+///           tx.put(to, *tx.find(to) + amount);
+///       });   // both balances change in one step, or neither does; rerun if a concurrent transfer got in first
+///   }
+///
+///   decltype(accounts)::read_scope snapshot{accounts};
+///   auto total = *snapshot.find("alice") + *snapshot.find("bob");
+/// ```
+
+#include <scope_exit/detail/rcu.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace scope_exit_v1
+{
+
+/// Thrown when a write scope read a key that a concurrent commit has changed since.
+class mvcc_conflict : public std::runtime_error
+{
+public:
+    mvcc_conflict()
+        : std::runtime_error{"mvcc_store: a key read by the write scope was changed by another commit"}
+    {}
+};
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class mvcc_store
+{
+    // A version is either full (`prev == nullptr`, all entries in `base`) or a delta of writes on top of `prev`.
+    struct version
+    {
+        struct write
+        {
+            std::size_t hash;
+            Key key;
+            std::optional<Value> value;  // nullopt erases
+        };
+
+        Value const * find(Key const & key, std::size_t h) const
+        {
+            for (version const * v = this; v != nullptr; v = v->prev)
+            {
+                if (v->prev == nullptr)
+                {
+                    auto it = v->base.find(key);
+                    return it != v->base.end() ? &it->second : nullptr;
+                }
+                for (auto const & w : v->writes)
+                {
+                    if (w.hash == h && KeyEqual{}(w.key, key))
+                    {
+                        return w.value ? &*w.value : nullptr;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        std::uint64_t number = 0;
+        std::size_t depth = 0;
+        version const * prev = nullptr;
+        std::vector<write> writes;
+        std::unordered_map<Key, Value, Hash, KeyEqual> base;
+    };
+
+    // A key a write scope read from its snapshot.  Versions are immutable, so as long as the snapshot is pinned the
+    // key is unchanged exactly when the newer version still resolves it to the same entry.
+    struct read
+    {
+        std::size_t hash;
+        Key key;
+        Value const * seen;
+    };
+
+public:
+    /// Deltas allowed on top of a full version before the chain is folded.
+    static constexpr std::size_t max_chain = 16;
+    /// Write sets larger than this are published as a full version right away.
+    static constexpr std::size_t max_delta = 32;
+
+    mvcc_store()
+        : head_{new version{}}
+    {}
+
+    mvcc_store(mvcc_store const &) = delete;
+    mvcc_store & operator=(mvcc_store const &) = delete;
+
+    /// Must not run concurrently with readers or writers.
+    ~mvcc_store() { delete_chain(head_.load(std::memory_order_relaxed)); }
+
+    /// Pins the current version for the lifetime of the scope.
+    class read_scope
+    {
+    public:
+        explicit read_scope(mvcc_store const & store)
+        {
+            detail::rcu::read_lock();
+            version_ = store.head_.load(std::memory_order_acquire);
+        }
+
+        read_scope(read_scope const &) = delete;
+        read_scope & operator=(read_scope const &) = delete;
+
+        ~read_scope() { detail::rcu::read_unlock(); }
+
+        /// The value of `key` in the pinned version, or nullptr.  Valid until the scope ends.
+        Value const * find(Key const & key) const { return version_->find(key, Hash{}(key)); }
+
+        /// Number of commits the pinned version includes.
+        std::uint64_t number() const { return version_->number; }
+
+    private:
+        version const * version_;
+    };
+
+    /// Reads a pinned snapshot, buffers writes and publishes them as one new version when the scope exits normally.
+    /// The destructor throws `mvcc_conflict` instead if a key read from the snapshot has been written since.
+    class write_scope
+    {
+    public:
+        explicit write_scope(mvcc_store & store)
+            : store_{store}
+            , snapshot_{store.head_.load(std::memory_order_acquire)}
+            , uncaught_count_{std::uncaught_exceptions()}
+        {}
+
+        write_scope(write_scope const &) = delete;
+        write_scope & operator=(write_scope const &) = delete;
+
+        ~write_scope() noexcept(false)
+        {
+            if (std::uncaught_exceptions() <= uncaught_count_ && !writes_.empty())
+            {
+                store_.commit(std::move(writes_), reads_);
+            }
+        }
+
+        void put(Key const & key, Value value) { write(key, std::optional<Value>{std::move(value)}); }
+
+        void erase(Key const & key) { write(key, std::nullopt); }
+
+        /// The value of `key` as this scope would commit it: its own writes first, then the pinned snapshot.  Keys
+        /// read from the snapshot are checked for concurrent changes at commit.
+        std::optional<Value> find(Key const & key)
+        {
+            auto h = Hash{}(key);
+            for (auto const & w : writes_)
+            {
+                if (w.hash == h && KeyEqual{}(w.key, key))
+                {
+                    return w.value;
+                }
+            }
+
+            Value const * v = snapshot_->find(key, h);
+            if (std::none_of(reads_.begin(), reads_.end(), [&](read const & r) {
+                    return r.hash == h && KeyEqual{}(r.key, key);
+                }))
+            {
+                reads_.push_back({h, key, v});
+            }
+            return v != nullptr ? std::optional<Value>{*v} : std::nullopt;
+        }
+
+        /// Number of distinct keys written.
+        std::size_t size() const { return writes_.size(); }
+
+    private:
+        void write(Key const & key, std::optional<Value> value)
+        {
+            auto h = Hash{}(key);
+            for (auto & w : writes_)
+            {
+                if (w.hash == h && KeyEqual{}(w.key, key))
+                {
+                    w.value = std::move(value);
+                    return;
+                }
+            }
+            writes_.push_back({h, key, std::move(value)});
+        }
+
+        detail::rcu_read_guard pin_;  // keeps `snapshot_` alive
+        mvcc_store & store_;
+        version const * snapshot_;
+        int uncaught_count_;
+        std::vector<typename version::write> writes_;
+        std::vector<read> reads_;
+    };
+
+    /// Run `transaction(tx)` on a fresh write scope until it commits without a conflict.  Exceptions other than
+    /// `mvcc_conflict` propagate and drop the writes, as they would from a plain write scope.
+    template <typename Transaction>
+    void update(Transaction && transaction)
+    {
+        for (;;)
+        {
+            try
+            {
+                write_scope tx{*this};
+                transaction(tx);
+                return;
+            }
+            catch (mvcc_conflict const &)
+            {
+            }
+        }
+    }
+
+    /// Number of commits in the current version.
+    std::uint64_t version_number() const
+    {
+        read_scope snapshot{*this};
+        return snapshot.number();
+    }
+
+private:
+    static void delete_chain(version const * v)
+    {
+        while (v != nullptr)
+        {
+            version const * prev = v->prev;
+            delete v;
+            v = prev;
+        }
+    }
+
+    // Fold the chain below `top` into a single full version.
+    static version * flatten(version const * top, std::vector<typename version::write> const * extra)
+    {
+        std::vector<version const *> chain;
+        version const * v = top;
+        for (; v->prev != nullptr; v = v->prev)
+        {
+            chain.push_back(v);
+        }
+
+        std::unique_ptr<version> full{new version{}};
+        full->base = v->base;
+        auto apply = [&full](std::vector<typename version::write> const & writes) {
+            for (auto const & w : writes)
+            {
+                if (w.value)
+                {
+                    full->base.insert_or_assign(w.key, *w.value);
+                }
+                else
+                {
+                    full->base.erase(w.key);
+                }
+            }
+        };
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        {
+            apply((*it)->writes);
+        }
+        if (extra != nullptr)
+        {
+            apply(*extra);
+        }
+        return full.release();
+    }
+
+    // Folding copies the entries, so a read may conflict spuriously after a fold; the transaction is then rerun.
+    static void validate(version const * head, std::vector<read> const & reads)
+    {
+        for (auto const & r : reads)
+        {
+            if (head->find(r.key, r.hash) != r.seen)
+            {
+                throw mvcc_conflict{};
+            }
+        }
+    }
+
+    void commit(std::vector<typename version::write> writes, std::vector<read> const & reads)
+    {
+        detail::rcu_read_guard pin;
+
+        if (writes.size() > max_delta)
+        {
+            // publish a full version directly; the chain it replaces is retired as a whole
+            version * head = head_.load(std::memory_order_acquire);
+            for (;;)
+            {
+                validate(head, reads);
+                version * full = flatten(head, &writes);
+                full->number = head->number + 1;
+                if (head_.compare_exchange_strong(head, full, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    retire_chain(head);
+                    return;
+                }
+                delete full;
+            }
+        }
+
+        std::unique_ptr<version> delta{new version{}};
+        delta->writes = std::move(writes);
+        version * head = head_.load(std::memory_order_acquire);
+        do
+        {
+            validate(head, reads);
+            delta->prev = head;
+            delta->number = head->number + 1;
+            delta->depth = head->depth + 1;
+        } while (!head_.compare_exchange_weak(head, delta.get(), std::memory_order_acq_rel, std::memory_order_acquire));
+        version * top = delta.release();
+
+        if (top->depth >= max_chain)
+        {
+            // compaction is best effort: if another commit got in first, a later one will fold the chain
+            version * full;
+            try
+            {
+                full = flatten(top, nullptr);
+            }
+            catch (std::bad_alloc const &)
+            {
+                return;  // the commit itself has succeeded
+            }
+            full->number = top->number;
+            version * expected = top;
+            if (head_.compare_exchange_strong(expected, full, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                retire_chain(top);
+            }
+            else
+            {
+                delete full;
+            }
+        }
+    }
+
+    static void retire_chain(version const * top)
+    {
+        detail::rcu::retire(const_cast<version *>(top), [](void * p) { delete_chain(static_cast<version *>(p)); });
+    }
+
+    std::atomic<version *> head_;
+};
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
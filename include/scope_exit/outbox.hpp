@@ -0,0 +1,266 @@
+#pragma once
+
+/// Purpose: deliver events emitted inside a scope only if the scope succeeds.
+///
+/// An `outbox` collects events in a per-thread arena while the scope runs.  When the scope exits normally the events
+/// are published to an `event_channel` as one contiguous batch; when it exits through an exception they are dropped
+/// by rewinding the arena, which is O(1) for trivially destructible events.  Outboxes for the same channel nest: an
+/// inner outbox that succeeds hands its events over to the enclosing one, so they are published only if every
+/// enclosing scope succeeds too.  Publishing waits for room in a full channel for at most a second (configurable per
+/// outbox); events still unsent after that are dropped and counted, so a stalled consumer cannot hang the producer.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::event_channel<order_event> orders{4096};
+///
+///   void place(order const & o)
+///   {
+///       scope_exit_v1::outbox<order_event> box{orders};
+///       reserve_stock(o);
+///       box.emit(order_event::reserved, o.id());
+///       charge(o);  // throws: nothing is published
+///       box.emit(order_event::charged, o.id());
+///   }
+/// ```
+
+#include <scope_exit/detail/arena.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+/// Bounded multi-producer multi-consumer queue that outboxes publish into.
+template <typename Event>
+class event_channel
+{
+public:
+    static_assert(std::is_nothrow_move_constructible<Event>::value, "events must be nothrow movable");
+
+    explicit event_channel(std::size_t capacity)
+        : ring_{capacity}
+    {}
+
+    /// Publish a single event.  Returns false if the channel is full.
+    template <typename E>
+    bool try_publish(E && event)
+    {
+        return ring_.try_push(std::forward<E>(event));
+    }
+
+    /// Publish `count` events in one step, waiting up to `max_wait` for room while the channel is full.  Batches
+    /// larger than the channel are split into capacity-sized parts.  Returns the number of events published; the
+    /// ones still unsent when the wait runs out are dropped and counted in `dropped()`.
+    template <typename It>
+    std::size_t publish(It first, std::size_t count, std::chrono::steady_clock::duration max_wait = wait_forever)
+    {
+        std::chrono::steady_clock::time_point deadline{};  // set once the channel is first found full
+        std::size_t published = 0;
+        while (published != count)
+        {
+            std::size_t n = count - published < ring_.capacity() ? count - published : ring_.capacity();
+            while (!ring_.try_push_batch(first, n))
+            {
+                auto const now = std::chrono::steady_clock::now();
+                if (deadline == std::chrono::steady_clock::time_point{})
+                {
+                    deadline = max_wait == wait_forever ? std::chrono::steady_clock::time_point::max() : now + max_wait;
+                }
+                else if (now >= deadline)
+                {
+                    dropped_.fetch_add(count - published, std::memory_order_relaxed);
+                    return published;
+                }
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                ++first;
+            }
+            published += n;
+        }
+        return published;
+    }
+
+    bool try_pop(Event & out) { return ring_.try_pop(out); }
+
+    /// Pop queued events and pass them to `sink`.  Returns the number of events consumed.
+    template <typename Sink>
+    std::size_t drain(Sink && sink)
+    {
+        std::size_t n = 0;
+        Event event;
+        while (ring_.try_pop(event))
+        {
+            sink(event);
+            ++n;
+        }
+        return n;
+    }
+
+    /// Approximate number of queued events.
+    std::size_t size() const { return ring_.size(); }
+
+    std::size_t capacity() const { return ring_.capacity(); }
+
+    /// Events given up on because the channel stayed full for longer than the publisher would wait.
+    std::size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static constexpr std::chrono::steady_clock::duration wait_forever = std::chrono::steady_clock::duration::max();
+
+private:
+    detail::mpmc_ring<Event> ring_;
+    std::atomic<std::size_t> dropped_{0};
+};
+
+/// Publishing happens in the destructor, so it must not wait for a stalled consumer forever: if the channel stays
+/// full for longer than `max_wait` the unsent events are dropped and counted in `event_channel::dropped()`.
+template <typename Event>
+class outbox
+{
+public:
+    static constexpr std::chrono::steady_clock::duration default_max_wait = std::chrono::seconds{1};
+
+    explicit outbox(event_channel<Event> & channel, std::chrono::steady_clock::duration max_wait = default_max_wait)
+        : channel_{channel}
+        , max_wait_{max_wait}
+        , parent_{current_}
+        , mark_{arena_.save()}
+        , uncaught_count_{std::uncaught_exceptions()}
+    {
+        current_ = this;
+    }
+
+    outbox(outbox const &) = delete;
+    outbox & operator=(outbox const &) = delete;
+
+    ~outbox()
+    {
+        current_ = parent_;
+        if (std::uncaught_exceptions() > uncaught_count_)
+        {
+            discard();
+        }
+        else if (parent_ != nullptr && &parent_->channel_ == &channel_)
+        {
+            // the parent now owns the nodes; they sit in the arena above its mark, so its rewind frees them
+            parent_->splice(*this);
+        }
+        else
+        {
+            publish();
+        }
+    }
+
+    /// The calling thread's innermost outbox for this event type, or nullptr.
+    static outbox * current() { return current_; }
+
+    outbox * parent() const { return parent_; }
+
+    /// Queue an event for publication on success.  Only the innermost outbox may emit, since an enclosing one
+    /// cannot grow its part of the arena while an inner outbox holds the top of it; emitting into an enclosing
+    /// outbox throws `std::logic_error`.
+    template <typename... Args>
+    Event & emit(Args &&... args)
+    {
+        if (current_ != this)
+        {
+            throw std::logic_error("outbox: only the innermost outbox may emit");
+        }
+
+        auto * n = static_cast<node *>(arena_.allocate(sizeof(node), alignof(node)));
+        Event * event = ::new (static_cast<void *>(n->storage)) Event(std::forward<Args>(args)...);
+        n->next = nullptr;
+        *tail_ = n;
+        tail_ = &n->next;
+        ++size_;
+        return *event;
+    }
+
+    /// Number of events pending in this outbox, including those handed over by nested outboxes.
+    std::size_t size() const { return size_; }
+
+private:
+    struct node
+    {
+        node * next;
+        alignas(Event) unsigned char storage[sizeof(Event)];
+
+        Event & value() { return *std::launder(reinterpret_cast<Event *>(storage)); }
+    };
+
+    struct iterator
+    {
+        node * n;
+
+        Event & operator*() const { return n->value(); }
+        iterator & operator++()
+        {
+            n = n->next;
+            return *this;
+        }
+    };
+
+    void splice(outbox & child)
+    {
+        if (child.head_ != nullptr)
+        {
+            *tail_ = child.head_;
+            tail_ = child.tail_;
+            size_ += child.size_;
+        }
+    }
+
+    void publish()
+    {
+        channel_.publish(iterator{head_}, size_, max_wait_);
+        discard();  // destroys the moved-from events
+    }
+
+    void discard()
+    {
+        if constexpr (!std::is_trivially_destructible<Event>::value)
+        {
+            for (node * n = head_; n != nullptr; n = n->next)
+            {
+                n->value().~Event();
+            }
+        }
+        arena_.rewind(mark_);
+    }
+
+    static thread_local detail::arena arena_;
+    static thread_local outbox * current_;
+
+    event_channel<Event> & channel_;
+    std::chrono::steady_clock::duration max_wait_;
+    outbox * parent_;
+    detail::arena::position mark_;
+    int uncaught_count_;
+    node * head_ = nullptr;
+    node ** tail_ = &head_;
+    std::size_t size_ = 0;
+};
+
+template <typename Event>
+thread_local detail::arena outbox<Event>::arena_;
+
+template <typename Event>
+thread_local outbox<Event> * outbox<Event>::current_ = nullptr;
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
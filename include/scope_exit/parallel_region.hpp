@@ -0,0 +1,394 @@
+#pragma once
+
+/// Purpose: bound nested parallelism with a per-thread thread budget.
+///
+/// Every thread has a thread budget, the hardware concurrency unless a `parallel_region_guard` on the thread says
+/// otherwise.  The outermost guard sets the budget; nested guards can only narrow it.  Each guard restores the
+/// previous budget on exit.  Code that parallelizes (thread pools, parallel algorithms) should ask `parallel_budget()`
+/// how many threads it may use.
+///
+/// `parallel_for` does so: it runs on at most `parallel_budget()` threads, the caller plus helpers from a shared pool,
+/// and hands each participant an equal share of the budget.  A `parallel_for` nested in the body of another one
+/// therefore runs serially once the outer loop has used up the budget, instead of oversubscribing the cores.  Work
+/// is balanced by stealing: every participant owns a range of indices and takes chunks from its front, and idle
+/// participants steal the upper half of the largest remaining range.
+///
+/// Example:
+/// ```
+///   void render(scene const & s)
+///   {
+///       scope(parallel_region, 4);  // this request may use 4 cores
+///       scope_exit_v1::parallel_for(0, s.tiles(), [&](std::size_t t) {
+///           shade(s, t);  // a parallel_for inside shade() sees a budget of 1
+///       });
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/detail/futex.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+inline thread_local unsigned parallel_budget_ = 0;  // 0: no region, use the hardware concurrency
+
+inline unsigned hardware_threads()
+{
+    static unsigned const n = std::max(1u, std::thread::hardware_concurrency());
+    return n;
+}
+
+}  // namespace detail
+
+/// Number of threads the calling thread may use for parallel work, including itself.
+inline unsigned parallel_budget()
+{
+    unsigned b = detail::parallel_budget_;
+    return b != 0 ? b : detail::hardware_threads();
+}
+
+/// Sets the calling thread's thread budget for the lifetime of the guard.  Inside another region the budget is at
+/// most that of the enclosing region.
+class parallel_region_guard
+{
+public:
+    explicit parallel_region_guard(unsigned threads)
+        : previous_{detail::parallel_budget_}
+    {
+        detail::parallel_budget_ = std::max(1u, previous_ != 0 ? std::min(threads, previous_) : threads);
+    }
+
+    parallel_region_guard(parallel_region_guard const &) = delete;
+    parallel_region_guard & operator=(parallel_region_guard const &) = delete;
+
+    ~parallel_region_guard() { detail::parallel_budget_ = previous_; }
+
+private:
+    unsigned previous_;
+};
+
+/// Fixed set of worker threads running submitted tasks in FIFO order.
+class thread_pool
+{
+public:
+    explicit thread_pool(unsigned threads)
+    {
+        workers_.reserve(threads);
+        for (unsigned i = 0; i != threads; ++i)
+        {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool & operator=(thread_pool const &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto & w : workers_)
+        {
+            w.join();
+        }
+    }
+
+    /// Pool shared by `parallel_for`, one worker per hardware thread besides the caller.
+    static thread_pool & global()
+    {
+        static thread_pool pool{detail::hardware_threads() - 1};
+        return pool;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            tasks_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+                ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+namespace detail
+{
+
+// State of one parallel_for call shared between the caller and its helpers.  Helpers that start after the caller
+// has closed the job leave without touching the body, so the caller only waits for helpers that have joined.
+class parallel_job
+{
+public:
+    static constexpr std::uint32_t closed = 1u << 31;
+
+    parallel_job(unsigned participants, std::size_t size, std::size_t grain, unsigned share)
+        : participants_{participants}
+        , grain_{grain}
+        , share_{share}
+        , slots_{new slot[participants]}
+    {
+        for (unsigned i = 0; i != participants; ++i)
+        {
+            slots_[i].range.store(pack(size * i / participants, size * (i + 1) / participants),
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Body>
+    void run_as_caller(std::size_t begin, Body & body)
+    {
+        participate(0, begin, body);
+
+        state_.fetch_or(closed, std::memory_order_acq_rel);
+        for (auto s = state_.load(std::memory_order_acquire); s != closed; s = state_.load(std::memory_order_acquire))
+        {
+            futex_wait(state_, s);
+        }
+
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    template <typename Body>
+    void run_as_helper(std::size_t begin, Body & body)
+    {
+        if (state_.fetch_add(1, std::memory_order_acquire) & closed)
+        {
+            leave();
+            return;
+        }
+
+        unsigned index = next_helper_.fetch_add(1, std::memory_order_relaxed);
+        if (index < participants_)
+        {
+            participate(index, begin, body);
+        }
+        leave();
+    }
+
+private:
+    struct alignas(cache_line_size) slot
+    {
+        std::atomic<std::uint64_t> range;  // [lo, hi) relative to `begin`, lo in the upper half
+    };
+
+    static std::uint64_t pack(std::size_t lo, std::size_t hi) { return std::uint64_t{lo} << 32 | hi; }
+    static std::size_t lo_of(std::uint64_t r) { return static_cast<std::size_t>(r >> 32); }
+    static std::size_t hi_of(std::uint64_t r) { return static_cast<std::size_t>(r & 0xffffffffu); }
+
+    void leave()
+    {
+        if (state_.fetch_sub(1, std::memory_order_acq_rel) == (closed | 1))
+        {
+            futex_wake(state_);
+        }
+    }
+
+    template <typename Body>
+    void participate(unsigned self, std::size_t begin, Body & body)
+    {
+        parallel_region_guard region{share_};
+        try
+        {
+            std::size_t lo;
+            std::size_t hi;
+            while (!failed_.load(std::memory_order_relaxed) && (take(self, lo, hi) || steal(self, lo, hi)))
+            {
+                for (std::size_t i = lo; i != hi; ++i)
+                {
+                    body(begin + i);
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{error_mutex_};
+            if (!error_)
+            {
+                error_ = std::current_exception();
+            }
+            failed_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Take the next chunk from the front of our own range.
+    bool take(unsigned self, std::size_t & lo, std::size_t & hi)
+    {
+        auto & range = slots_[self].range;
+        auto r = range.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            lo = lo_of(r);
+            hi = hi_of(r);
+            if (lo >= hi)
+            {
+                return false;
+            }
+            auto end = std::min(lo + grain_, hi);
+            if (range.compare_exchange_weak(r, pack(end, hi), std::memory_order_relaxed))
+            {
+                hi = end;
+                return true;
+            }
+        }
+    }
+
+    // Move the upper half of the largest remaining range into our own slot and take a chunk from it.
+    bool steal(unsigned self, std::size_t & lo, std::size_t & hi)
+    {
+        for (;;)
+        {
+            unsigned victim = participants_;
+            std::uint64_t best = 0;
+            std::size_t best_size = 0;
+            for (unsigned i = 0; i != participants_; ++i)
+            {
+                auto r = slots_[i].range.load(std::memory_order_relaxed);
+                if (hi_of(r) > lo_of(r) && hi_of(r) - lo_of(r) > best_size)
+                {
+                    victim = i;
+                    best = r;
+                    best_size = hi_of(r) - lo_of(r);
+                }
+            }
+            if (victim == participants_)
+            {
+                return false;
+            }
+
+            std::size_t mid = lo_of(best) + best_size / 2;
+            if (slots_[victim].range.compare_exchange_strong(best, pack(lo_of(best), mid),
+                                                             std::memory_order_relaxed))
+            {
+                slots_[self].range.store(pack(mid, hi_of(best)), std::memory_order_relaxed);
+                if (take(self, lo, hi))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    unsigned const participants_;
+    std::size_t const grain_;
+    unsigned const share_;
+    std::unique_ptr<slot[]> const slots_;
+    std::atomic<std::uint32_t> state_{0};  // number of helpers inside, plus `closed`
+    std::atomic<unsigned> next_helper_{1};
+    std::atomic<bool> failed_{false};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+}  // namespace detail
+
+/// Call `body(i)` for every i in [begin, end) on the calling thread and helpers from `pool`, using at most
+/// `parallel_budget()` threads in total.  `grain` is the number of consecutive indices a thread takes at a time; 0
+/// picks one based on the range and the number of threads.  The first exception thrown by `body` stops the loop and
+/// is rethrown to the caller.
+template <typename Body>
+void parallel_for(thread_pool & pool, std::size_t begin, std::size_t end, Body && body, std::size_t grain = 0)
+{
+    constexpr std::size_t max_window = 0xffffffffu;
+    unsigned const budget = parallel_budget();
+
+    while (begin < end)
+    {
+        std::size_t size = std::min(end - begin, max_window);
+        std::size_t g = grain;
+        unsigned participants = std::min(budget, pool.size() + 1);
+        if (g == 0)
+        {
+            g = std::max<std::size_t>(1, size / (std::size_t{participants} * 8));
+        }
+        participants = static_cast<unsigned>(std::min<std::size_t>(participants, (size + g - 1) / g));
+
+        if (participants <= 1)
+        {
+            for (std::size_t i = begin; i != begin + size; ++i)
+            {
+                body(i);
+            }
+        }
+        else
+        {
+            unsigned share = std::max(1u, budget / participants);
+            auto job = std::make_shared<detail::parallel_job>(participants, size, g, share);
+            for (unsigned i = 1; i != participants; ++i)
+            {
+                pool.submit([job, begin, &body] { job->run_as_helper(begin, body); });
+            }
+            job->run_as_caller(begin, body);
+        }
+
+        begin += size;
+    }
+}
+
+/// `parallel_for` on the shared pool.
+template <typename Body>
+void parallel_for(std::size_t begin, std::size_t end, Body && body, std::size_t grain = 0)
+{
+    parallel_for(thread_pool::global(), begin, end, std::forward<Body>(body), grain);
+}
+
+}  // namespace scope_exit_v1
+
+#define scope_parallel_region(threads)                                                                                 \
+    [[maybe_unused]] scope_exit_v1::parallel_region_guard const SCOPE_CONCAT_(scope_parallel_region_obj_,             \
+                                                                              __COUNTER__){threads}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,382 @@
+#pragma once
+
+/// Purpose: kill and reap child processes on every scope exit path (Linux only).
+///
+/// The guards track children through pidfds, so reaping neither needs a SIGCHLD handler nor polling and can never
+/// hit a recycled pid.  On normal scope exit the children are waited for; when the scope is left by an exception
+/// they are killed first and then reaped.
+///
+/// Example:
+/// ```
+///   auto helper = scope_exit_v1::process_guard::spawn({"/usr/bin/helper", "--serve"});
+///   talk_to(helper.pid());
+///   // helper is waited for on success, killed and reaped on failure
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <exception>
+#include <initializer_list>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+#ifndef P_PIDFD
+constexpr idtype_t P_PIDFD = static_cast<idtype_t>(3);
+#endif
+
+[[noreturn]] inline void throw_errno(char const * what) { throw std::system_error(errno, std::system_category(), what); }
+
+inline int pidfd_open(pid_t pid) { return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0)); }
+
+inline int pidfd_send_signal(int pidfd, int sig)
+{
+    return static_cast<int>(::syscall(SYS_pidfd_send_signal, pidfd, sig, nullptr, 0));
+}
+
+// Convert waitid() result into a shell-like status: exit code, or negated signal number.
+inline int decode_status(siginfo_t const & info)
+{
+    return info.si_code == CLD_EXITED ? info.si_status : -info.si_status;
+}
+
+// Reap a child through its pidfd.  Returns false when `options` contains WNOHANG and the child is still running.
+inline bool pidfd_reap(int pidfd, int options, int & status)
+{
+    siginfo_t info{};
+    while (::waitid(P_PIDFD, static_cast<id_t>(pidfd), &info, WEXITED | options) != 0)
+    {
+        if (errno != EINTR)
+        {
+            throw_errno("waitid");
+        }
+    }
+
+    if (info.si_pid == 0)
+    {
+        return false;
+    }
+
+    status = decode_status(info);
+    return true;
+}
+
+inline pid_t spawn_process(char const * const * argv)
+{
+    pid_t pid = 0;
+    int rc = ::posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char * const *>(argv), environ);
+    if (rc != 0)
+    {
+        throw std::system_error(rc, std::system_category(), "posix_spawn");
+    }
+
+    return pid;
+}
+
+inline pid_t spawn_process(std::initializer_list<char const *> args)
+{
+    std::vector<char const *> argv(args);
+    argv.push_back(nullptr);
+    return spawn_process(argv.data());
+}
+
+struct child
+{
+    pid_t pid;
+    int pidfd;
+};
+
+// Kill and reap a child that cannot be tracked, rather than leave it running or a zombie.  Never for pid <= 0,
+// which kill() and waitpid() take to mean a whole process group.  Preserves errno.
+inline void kill_untracked(pid_t pid) noexcept
+{
+    int const error = errno;
+    if (pid > 0)
+    {
+        ::kill(pid, SIGKILL);
+        while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+    errno = error;
+}
+
+inline child adopt_child(pid_t pid)
+{
+    int pidfd = pidfd_open(pid);
+    if (pidfd < 0)
+    {
+        kill_untracked(pid);
+        throw_errno("pidfd_open");
+    }
+
+    return {pid, pidfd};
+}
+
+}  // namespace detail
+
+/// Owns a single child process.  The destructor waits for the child on normal scope exit and kills it with
+/// `kill_signal()` before waiting when the scope is left by an exception.
+class process_guard
+{
+public:
+    /// Adopt an already started child of the calling process.  If it cannot be tracked the child is killed and
+    /// reaped before the `std::system_error` is thrown.
+    explicit process_guard(pid_t pid)
+        : child_{detail::adopt_child(pid)}
+        , uncaught_count_{std::uncaught_exceptions()}
+    {}
+
+    /// Spawn `args[0]` (an absolute path) with the given argument vector.
+    static process_guard spawn(std::initializer_list<char const *> args)
+    {
+        return process_guard{detail::spawn_process(args)};
+    }
+
+    process_guard(process_guard && other) noexcept
+        : child_{std::exchange(other.child_, detail::child{-1, -1})}
+        , uncaught_count_{other.uncaught_count_}
+        , kill_signal_{other.kill_signal_}
+        , status_{other.status_}
+    {}
+
+    process_guard(process_guard const &) = delete;
+    process_guard & operator=(process_guard const &) = delete;
+    process_guard & operator=(process_guard &&) = delete;
+
+    ~process_guard()
+    {
+        if (child_.pidfd < 0)
+        {
+            return;
+        }
+
+        try
+        {
+            if (std::uncaught_exceptions() > uncaught_count_)
+            {
+                kill(kill_signal_);
+            }
+            wait();
+        }
+        catch (...)
+        {
+            // nothing sensible to do in a destructor
+        }
+    }
+
+    pid_t pid() const { return child_.pid; }
+    int pidfd() const { return child_.pidfd; }
+
+    /// Signal used to terminate the child when the scope fails (SIGKILL by default).
+    int kill_signal() const { return kill_signal_; }
+    void set_kill_signal(int sig) { kill_signal_ = sig; }
+
+    /// Send a signal to the child.  Does nothing once the child has been reaped.
+    void kill(int sig = SIGKILL)
+    {
+        if (child_.pidfd >= 0 && detail::pidfd_send_signal(child_.pidfd, sig) != 0 && errno != ESRCH)
+        {
+            detail::throw_errno("pidfd_send_signal");
+        }
+    }
+
+    /// Block until the child exits and reap it.  Returns the exit code, or the negated signal number if the child
+    /// was killed by a signal.  Subsequent calls return the same status.
+    int wait()
+    {
+        if (child_.pidfd >= 0)
+        {
+            detail::pidfd_reap(child_.pidfd, 0, status_);
+            close_pidfd();
+        }
+
+        return status_;
+    }
+
+    /// Reap the child if it has exited.  Returns true and stores the status on success.
+    bool try_wait(int & status)
+    {
+        if (child_.pidfd >= 0)
+        {
+            if (!detail::pidfd_reap(child_.pidfd, WNOHANG, status_))
+            {
+                return false;
+            }
+            close_pidfd();
+        }
+
+        status = status_;
+        return true;
+    }
+
+private:
+    void close_pidfd()
+    {
+        ::close(child_.pidfd);
+        child_.pidfd = -1;
+    }
+
+    detail::child child_;
+    int uncaught_count_;
+    int kill_signal_ = SIGKILL;
+    int status_ = 0;
+};
+
+/// Owns a batch of child processes and reaps all of them at scope exit with a single epoll set over their pidfds,
+/// in the order they exit.  Like process_guard, the children are killed first when the scope fails.
+class process_group_guard
+{
+public:
+    process_group_guard()
+        : uncaught_count_{std::uncaught_exceptions()}
+    {}
+
+    process_group_guard(process_group_guard const &) = delete;
+    process_group_guard & operator=(process_group_guard const &) = delete;
+
+    ~process_group_guard()
+    {
+        try
+        {
+            if (std::uncaught_exceptions() > uncaught_count_)
+            {
+                kill_all(kill_signal_);
+            }
+            wait_all();
+        }
+        catch (...)
+        {
+            // nothing sensible to do in a destructor
+        }
+    }
+
+    /// Adopt an already started child.  If it cannot be tracked or added, the child is killed and reaped before
+    /// the exception is thrown.
+    void adopt(pid_t pid)
+    {
+        auto c = detail::adopt_child(pid);
+        scope(failure)
+        {
+            ::close(c.pidfd);
+            detail::kill_untracked(c.pid);
+        };
+        children_.push_back(c);
+    }
+
+    /// Spawn a child and add it to the group.  Returns its pid.
+    pid_t spawn(std::initializer_list<char const *> args)
+    {
+        pid_t pid = detail::spawn_process(args);
+        adopt(pid);
+        return pid;
+    }
+
+    std::size_t size() const { return children_.size(); }
+
+    int kill_signal() const { return kill_signal_; }
+    void set_kill_signal(int sig) { kill_signal_ = sig; }
+
+    void kill_all(int sig = SIGKILL)
+    {
+        for (auto const & c : children_)
+        {
+            detail::pidfd_send_signal(c.pidfd, sig);
+        }
+    }
+
+    /// Block until every child has exited.  Returns {pid, status} pairs in the order the children were reaped.  Each
+    /// child leaves the group as soon as it is reaped, so after an error a later call waits for the rest.
+    std::vector<std::pair<pid_t, int>> wait_all()
+    {
+        std::vector<std::pair<pid_t, int>> reaped;
+        reaped.reserve(children_.size());
+
+        if (children_.empty())
+        {
+            return reaped;
+        }
+
+        int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epfd < 0)
+        {
+            detail::throw_errno("epoll_create1");
+        }
+        scope(exit) { ::close(epfd); };
+
+        for (auto const & c : children_)
+        {
+            if (c.pidfd < 0)
+            {
+                continue;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = c.pidfd;
+            if (::epoll_ctl(epfd, EPOLL_CTL_ADD, c.pidfd, &ev) != 0)
+            {
+                detail::throw_errno("epoll_ctl");
+            }
+        }
+
+        epoll_event events[64];
+        while (!children_.empty())
+        {
+            int n = ::epoll_wait(epfd, events, 64, -1);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                detail::throw_errno("epoll_wait");
+            }
+
+            for (int k = 0; k != n; ++k)
+            {
+                auto it = std::find_if(children_.begin(), children_.end(),
+                                       [fd = events[k].data.fd](detail::child const & c) { return c.pidfd == fd; });
+                int status = 0;
+                if (it != children_.end() && detail::pidfd_reap(it->pidfd, WNOHANG, status))
+                {
+                    ::epoll_ctl(epfd, EPOLL_CTL_DEL, it->pidfd, nullptr);
+                    ::close(it->pidfd);
+                    reaped.emplace_back(it->pid, status);
+                    *it = children_.back();
+                    children_.pop_back();
+                }
+            }
+        }
+
+        return reaped;
+    }
+
+private:
+    std::vector<detail::child> children_;
+    int uncaught_count_;
+    int kill_signal_ = SIGKILL;
+};
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
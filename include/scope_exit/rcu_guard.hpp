@@ -0,0 +1,142 @@
+#pragma once
+
+/// Purpose: read-mostly objects that readers access without atomic read-modify-write and writers replace as a whole.
+///
+/// An `rcu_cell` holds a pointer to an immutable object.  `read()` pins the current object for the lifetime of the
+/// returned guard; `update()` returns a guard holding a private copy of the current object.  When the update guard's
+/// scope exits normally the copy is published with an atomic pointer swap and the old object is retired until every
+/// reader that could still see it is gone.  When the scope exits through an exception the copy is dropped.  Updates
+/// are serialized by a mutex, so each one starts from the latest published object.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::rcu_cell<config> current{load_config()};
+///
+///   void reload(std::string const & path)
+///   {
+///       auto draft = current.update();
+///       draft->routes = parse_routes(path);  // throws: readers keep the old config
+///       draft->version += 1;
+///   }
+///
+///   void serve(request const & r)
+///   {
+///       auto cfg = current.read();
+///       route(r, cfg->routes);
+///   }
+/// ```
+
+#include <scope_exit/detail/rcu.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+template <typename T>
+class rcu_cell
+{
+public:
+    /// Pins the object that was current when the guard was created.
+    class read_guard
+    {
+    public:
+        explicit read_guard(rcu_cell const & cell)
+        {
+            detail::rcu::read_lock();
+            object_ = cell.current_.load(std::memory_order_acquire);
+        }
+
+        read_guard(read_guard const &) = delete;
+        read_guard & operator=(read_guard const &) = delete;
+
+        ~read_guard() { detail::rcu::read_unlock(); }
+
+        T const & operator*() const { return *object_; }
+        T const * operator->() const { return object_; }
+        T const * get() const { return object_; }
+
+    private:
+        T const * object_;
+    };
+
+    /// Holds a private copy of the current object and publishes it when the scope exits normally.
+    class update_guard
+    {
+    public:
+        explicit update_guard(rcu_cell & cell)
+            : cell_{cell}
+            , lock_{cell.update_mutex_}
+            , draft_{std::make_unique<T>(*cell.current_.load(std::memory_order_relaxed))}
+            , uncaught_count_{std::uncaught_exceptions()}
+        {}
+
+        update_guard(update_guard const &) = delete;
+        update_guard & operator=(update_guard const &) = delete;
+
+        ~update_guard() noexcept(false)
+        {
+            if (std::uncaught_exceptions() <= uncaught_count_ && draft_ != nullptr)
+            {
+                cell_.publish(std::move(draft_));
+            }
+        }
+
+        T & operator*() const { return *draft_; }
+        T * operator->() const { return draft_.get(); }
+
+        /// Drop the copy; the current object stays published.
+        void cancel() { draft_.reset(); }
+
+    private:
+        rcu_cell & cell_;
+        std::lock_guard<std::mutex> lock_;
+        std::unique_ptr<T> draft_;
+        int uncaught_count_;
+    };
+
+    template <typename... Args>
+    explicit rcu_cell(Args &&... args)
+        : current_{new T(std::forward<Args>(args)...)}
+    {}
+
+    rcu_cell(rcu_cell const &) = delete;
+    rcu_cell & operator=(rcu_cell const &) = delete;
+
+    /// Must not run concurrently with readers or writers.
+    ~rcu_cell() { delete current_.load(std::memory_order_relaxed); }
+
+    read_guard read() const { return read_guard{*this}; }
+
+    update_guard update() { return update_guard{*this}; }
+
+    /// Replace the object outright, without starting from a copy.
+    void store(std::unique_ptr<T> object)
+    {
+        std::lock_guard<std::mutex> lock{update_mutex_};
+        publish(std::move(object));
+    }
+
+private:
+    // Called with `update_mutex_` held.
+    void publish(std::unique_ptr<T> object)
+    {
+        T * old = current_.exchange(object.release(), std::memory_order_acq_rel);
+        detail::rcu::retire(old, [](void * p) { delete static_cast<T *>(p); });
+    }
+
+    std::atomic<T *> current_;
+    std::mutex update_mutex_;
+};
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -9,21 +9,70 @@
 /// ```
 
 #include <exception>
+#include <type_traits>
 #include <utility>
 
+// The guards are C++17.  Compiled as C++20 or later they also
+// - tell the compiler which branch of the success and failure checks is cold (`[[likely]]`, `[[unlikely]]`)
+// - are usable in constant expressions, where no exception can be in flight
+// Neither changes the guard layout, so translation units built with different standards agree on it.  The action is
+// deliberately not `[[no_unique_address]]`: that would make the size of a guard depend on the standard.
+#if defined(_MSVC_LANG)
+#define SCOPE_CPLUSPLUS_ _MSVC_LANG
+#else
+#define SCOPE_CPLUSPLUS_ __cplusplus
+#endif
+
+#if SCOPE_CPLUSPLUS_ >= 202002L
+#define SCOPE_CONSTEXPR20_ constexpr
+#define SCOPE_LIKELY_      [[likely]]
+#define SCOPE_UNLIKELY_    [[unlikely]]
+#else
+#define SCOPE_CONSTEXPR20_
+#define SCOPE_LIKELY_
+#define SCOPE_UNLIKELY_
+#endif
+
 namespace scope_exit_v1
 {
 namespace detail
 {
 
+/// True during constant evaluation, which guards only take part in from C++20 on.
+SCOPE_CONSTEXPR20_ inline bool is_constant_evaluated() noexcept
+{
+#if SCOPE_CPLUSPLUS_ >= 202002L
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+/// `std::uncaught_exceptions()`, or 0 during constant evaluation.
+SCOPE_CONSTEXPR20_ inline int uncaught_exceptions() noexcept
+{
+#if SCOPE_CPLUSPLUS_ >= 202302L && defined(__cpp_if_consteval)
+    if consteval
+    {
+        return 0;
+    }
+#elif SCOPE_CPLUSPLUS_ >= 202002L
+    if (std::is_constant_evaluated())
+    {
+        return 0;
+    }
+#endif
+    return std::uncaught_exceptions();
+}
+
 template <typename F>
 struct scope_guard
 {
-    scope_guard(F && f)
-        : action{f}
+    SCOPE_CONSTEXPR20_ scope_guard(F && f)
+        : action{std::move(f)}
     {}
 
-    ~scope_guard() noexcept(false) { action(); }
+    SCOPE_CONSTEXPR20_ ~scope_guard() noexcept(false) { action(); }
 
     F action;
 };
@@ -31,14 +80,14 @@ struct scope_guard
 template <typename F>
 struct scope_success_guard
 {
-    scope_success_guard(F && f)
-        : action{f}
-        , uncaught_count_{std::uncaught_exceptions()}
+    SCOPE_CONSTEXPR20_ scope_success_guard(F && f)
+        : action{std::move(f)}
+        , uncaught_count_{detail::uncaught_exceptions()}
     {}
 
-    ~scope_success_guard() noexcept(false)
+    SCOPE_CONSTEXPR20_ ~scope_success_guard() noexcept(false)
     {
-        if (std::uncaught_exceptions() == uncaught_count_)
+        if (detail::uncaught_exceptions() == uncaught_count_) SCOPE_LIKELY_
         {
             action();
         }
@@ -51,14 +100,14 @@ struct scope_success_guard
 template <typename F>
 struct scope_failure_guard
 {
-    scope_failure_guard(F && f)
-        : action{f}
-        , uncaught_count_{std::uncaught_exceptions()}
+    SCOPE_CONSTEXPR20_ scope_failure_guard(F && f)
+        : action{std::move(f)}
+        , uncaught_count_{detail::uncaught_exceptions()}
     {}
 
-    ~scope_failure_guard() noexcept(false)
+    SCOPE_CONSTEXPR20_ ~scope_failure_guard() noexcept(false)
     {
-        if (std::uncaught_exceptions() > uncaught_count_)
+        if (detail::uncaught_exceptions() > uncaught_count_) SCOPE_UNLIKELY_
         {
             action();
         }
@@ -71,27 +120,27 @@ struct scope_failure_guard
 struct scope_guard_tag
 {
     template <typename F>
-    friend auto operator+(scope_guard_tag, F && f)
+    friend SCOPE_CONSTEXPR20_ auto operator+(scope_guard_tag, F f)
     {
-        return scope_guard<F>(std::forward<F>(f));
+        return scope_guard<F>(std::move(f));
     }
 };
 
 struct scope_success_guard_tag
 {
     template <typename F>
-    friend auto operator+(scope_success_guard_tag, F && f)
+    friend SCOPE_CONSTEXPR20_ auto operator+(scope_success_guard_tag, F f)
     {
-        return scope_success_guard<F>(std::forward<F>(f));
+        return scope_success_guard<F>(std::move(f));
     }
 };
 
 struct scope_failure_guard_tag
 {
     template <typename F>
-    friend auto operator+(scope_failure_guard_tag, F && f)
+    friend SCOPE_CONSTEXPR20_ auto operator+(scope_failure_guard_tag, F f)
     {
-        return scope_failure_guard<F>(std::forward<F>(f));
+        return scope_failure_guard<F>(std::move(f));
     }
 };
 
@@ -101,16 +150,39 @@ struct scope_failure_guard_tag
 #define SCOPE_CONCAT2_(X, Y) X##Y
 #define SCOPE_CONCAT_(X, Y)  SCOPE_CONCAT2_(X, Y)
 
-#define scope(condition) scope_##condition
-#define scope_exit                                                                                                     \
-    [[maybe_unused]] auto const & SCOPE_CONCAT_(scope_guard_obj_, __COUNTER__) =                                       \
-        scope_exit_v1::detail::scope_guard_tag{} + [&]
-#define scope_success                                                                                                  \
-    [[maybe_unused]] auto const & SCOPE_CONCAT_(scope_success_guard_obj_, __COUNTER__) =                               \
-        scope_exit_v1::detail::scope_success_guard_tag{} + [&]
-#define scope_failure                                                                                                  \
-    [[maybe_unused]] auto const & SCOPE_CONCAT_(scope_failure_guard_obj_, __COUNTER__) =                               \
-        scope_exit_v1::detail::scope_failure_guard_tag{} + [&]
+// `scope(kind)` expands to `scope_kind`, `scope(kind, args...)` expands to `scope_kind(args...)`.  The second form
+// is used by guards that take parameters, like `scope(deadline, 10ms)` from deadline_guard.hpp.
+#define SCOPE_EXPAND_(X)                                      X
+#define SCOPE_SELECT_(_1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+#define SCOPE_ARITY_(...)                SCOPE_EXPAND_(SCOPE_SELECT_(__VA_ARGS__, N, N, N, N, N, N, N, 1, ~))
+#define SCOPE_DISPATCH_1(condition)      scope_##condition
+#define SCOPE_DISPATCH_N(condition, ...) scope_##condition(__VA_ARGS__)
+
+#define scope(...) SCOPE_EXPAND_(SCOPE_CONCAT_(SCOPE_DISPATCH_, SCOPE_ARITY_(__VA_ARGS__))(__VA_ARGS__))
+#define scope_exit    SCOPE_GUARD_(exit, scope_guard_tag, scope_guard_obj_, __COUNTER__)
+#define scope_success SCOPE_GUARD_(success, scope_success_guard_tag, scope_success_guard_obj_, __COUNTER__)
+#define scope_failure SCOPE_GUARD_(failure, scope_failure_guard_tag, scope_failure_guard_obj_, __COUNTER__)
+
+// With SCOPE_EXIT_INSTRUMENT defined, every guard is preceded by a probe recording per-site statistics; see
+// instrument.hpp.  The probe does nothing during constant evaluation, so constexpr guards stay constexpr.
+// SCOPE_EXIT_INSTRUMENT_DEPTH turns it on too and adds nesting depth and stack usage to the statistics.
+#if defined(SCOPE_EXIT_INSTRUMENT_DEPTH) && !defined(SCOPE_EXIT_INSTRUMENT)
+#define SCOPE_EXIT_INSTRUMENT
+#endif
+#if defined(SCOPE_EXIT_INSTRUMENT)
+#define SCOPE_PROBE_(kind, id) SCOPE_INSTRUMENT_PROBE_(kind, id);
+#else
+#define SCOPE_PROBE_(kind, id)
+#endif
+
+#define SCOPE_GUARD_(kind, tag, name, id)                                                                              \
+    SCOPE_PROBE_(kind, id)                                                                                             \
+    [[maybe_unused]] auto const SCOPE_CONCAT_(name, id) = scope_exit_v1::detail::tag{} + [&]
+
+#if defined(SCOPE_EXIT_INSTRUMENT)
+#include <scope_exit/instrument.hpp>
+#endif
 
 // Copyright Alexei Zakharov, 2025.
 //
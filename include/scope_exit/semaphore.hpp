@@ -0,0 +1,273 @@
+#pragma once
+
+/// Purpose: cap concurrent operations with permits that are returned at scope exit.
+///
+/// `admission_semaphore::acquire()` returns a `semaphore_permit` guard.  Acquiring and releasing is a single CAS /
+/// fetch_add when permits are available; threads that have to wait sleep on a futex.  With adaptive limiting
+/// enabled, permits released during exception unwinding count as failures and shrink the limit multiplicatively,
+/// while successful releases grow it additively (AIMD).
+///
+/// Example:
+/// ```
+///   static scope_exit_v1::admission_semaphore expensive{8};
+///
+///   auto permit = expensive.acquire();
+///   run_expensive_query();  // permit returned on scope exit
+/// ```
+
+#include <scope_exit/detail/futex.hpp>
+#include <scope_exit/scope_exit.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace scope_exit_v1
+{
+
+class admission_semaphore;
+
+/// Scope-bound ownership of `count()` permits.
+class semaphore_permit
+{
+public:
+    semaphore_permit() = default;
+
+    semaphore_permit(semaphore_permit && other) noexcept
+        : sem_{std::exchange(other.sem_, nullptr)}
+        , count_{other.count_}
+        , uncaught_count_{other.uncaught_count_}
+    {}
+
+    semaphore_permit & operator=(semaphore_permit && other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            sem_ = std::exchange(other.sem_, nullptr);
+            count_ = other.count_;
+            uncaught_count_ = other.uncaught_count_;
+        }
+        return *this;
+    }
+
+    ~semaphore_permit() { release(); }
+
+    explicit operator bool() const { return sem_ != nullptr; }
+    std::int32_t count() const { return sem_ != nullptr ? count_ : 0; }
+
+    /// Return the permits early.  Reports a failure to an adaptive semaphore if called during unwinding.
+    inline void release();
+
+private:
+    friend class admission_semaphore;
+
+    semaphore_permit(admission_semaphore * sem, std::int32_t count)
+        : sem_{sem}
+        , count_{count}
+        , uncaught_count_{std::uncaught_exceptions()}
+    {}
+
+    admission_semaphore * sem_ = nullptr;
+    std::int32_t count_ = 0;
+    int uncaught_count_ = 0;
+};
+
+/// Additive-increase / multiplicative-decrease settings for an adaptive semaphore.
+struct aimd_options
+{
+    std::int32_t min_limit = 1;
+    std::int32_t max_limit = 1024;
+    /// The limit grows by one after this many successful releases per permit of the current limit.
+    std::int32_t successes_per_increase = 1;
+    /// On failure the limit is multiplied by this factor.
+    double decrease_factor = 0.5;
+};
+
+class admission_semaphore
+{
+public:
+    explicit admission_semaphore(std::int32_t permits)
+        : count_{permits}
+        , limit_{permits}
+    {}
+
+    /// Adaptive semaphore: starts at `permits` and adjusts within the bounds of `options`.
+    admission_semaphore(std::int32_t permits, aimd_options const & options)
+        : count_{permits}
+        , limit_{permits}
+        , adaptive_{true}
+        , options_{options}
+    {}
+
+    admission_semaphore(admission_semaphore const &) = delete;
+    admission_semaphore & operator=(admission_semaphore const &) = delete;
+
+    /// Block until `n` permits are available and take them atomically.  Throws `std::invalid_argument` unless
+    /// 0 < n <= the limit, since more would never become available.  An adaptive semaphore only grows its limit as
+    /// permits are released, so `acquire` also throws instead of waiting while `n` is above the current limit, and a
+    /// waiter throws as soon as a failure shrinks the limit below its `n`.
+    semaphore_permit acquire(std::int32_t n = 1)
+    {
+        check_request(n);
+        if (!try_take(n))
+        {
+            wait_take(n);
+        }
+        return semaphore_permit{this, n};
+    }
+
+    /// Take `n` permits if they are available right now.  Returns an empty permit otherwise.  Throws unless
+    /// 0 < n <= the limit (the maximum limit of an adaptive semaphore).
+    semaphore_permit try_acquire(std::int32_t n = 1)
+    {
+        check_request(n);
+        return try_take(n) ? semaphore_permit{this, n} : semaphore_permit{};
+    }
+
+    /// Return `n` permits that were taken without a guard (see `semaphore_permit::release`).
+    void release(std::int32_t n = 1)
+    {
+        count_.fetch_add(n, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) != 0)
+        {
+            // waiters may want different batch sizes, so let all of them re-check
+            detail::futex_wake(count_);
+        }
+    }
+
+    /// Currently available permits.  Negative while an adaptive limit shrinks below the permits in use.
+    std::int32_t available() const { return count_.load(std::memory_order_relaxed); }
+
+    /// Current limit; fixed unless the semaphore is adaptive.
+    std::int32_t limit() const { return limit_.load(std::memory_order_relaxed); }
+
+    void record_success()
+    {
+        if (!adaptive_)
+        {
+            return;
+        }
+
+        auto limit = limit_.load(std::memory_order_relaxed);
+        if (successes_.fetch_add(1, std::memory_order_relaxed) + 1 >= limit * options_.successes_per_increase)
+        {
+            successes_.store(0, std::memory_order_relaxed);
+            resize(limit, std::min(options_.max_limit, limit + 1));
+        }
+    }
+
+    void record_failure()
+    {
+        if (!adaptive_)
+        {
+            return;
+        }
+
+        auto limit = limit_.load(std::memory_order_relaxed);
+        auto lowered = static_cast<std::int32_t>(static_cast<double>(limit) * options_.decrease_factor);
+        successes_.store(0, std::memory_order_relaxed);
+        resize(limit, std::max(options_.min_limit, lowered));
+    }
+
+private:
+    void check_request(std::int32_t n) const
+    {
+        if (n <= 0 || n > (adaptive_ ? options_.max_limit : limit()))
+        {
+            throw std::invalid_argument("admission_semaphore: permit count out of range");
+        }
+    }
+
+    bool try_take(std::int32_t n)
+    {
+        auto c = count_.load(std::memory_order_relaxed);
+        while (c >= n)
+        {
+            if (count_.compare_exchange_weak(c, c - n, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void wait_take(std::int32_t n)
+    {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        scope(exit) { waiters_.fetch_sub(1, std::memory_order_relaxed); };
+        for (;;)
+        {
+            auto c = count_.load(std::memory_order_seq_cst);
+            if (c >= n)
+            {
+                if (count_.compare_exchange_weak(c, c - n, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+            // no permit can come back before the limit grows, and only a successful release grows it
+            if (adaptive_ && n > limit_.load(std::memory_order_seq_cst))
+            {
+                throw std::invalid_argument("admission_semaphore: permit count above the current limit");
+            }
+            detail::futex_wait(count_, c);
+        }
+    }
+
+    // Move the limit from `from` to `to` and hand the difference to (or take it from) the available permits.
+    void resize(std::int32_t from, std::int32_t to)
+    {
+        if (from != to && limit_.compare_exchange_strong(from, to, std::memory_order_seq_cst))
+        {
+            if (to > from)
+            {
+                release(to - from);
+            }
+            else
+            {
+                count_.fetch_sub(from - to, std::memory_order_seq_cst);
+                if (waiters_.load(std::memory_order_seq_cst) != 0)
+                {
+                    // waiters that want more than the new limit give up
+                    detail::futex_wake(count_);
+                }
+            }
+        }
+    }
+
+    std::atomic<std::int32_t> count_;
+    std::atomic<std::uint32_t> waiters_{0};
+    std::atomic<std::int32_t> limit_;
+    std::atomic<std::int32_t> successes_{0};
+    bool adaptive_ = false;
+    aimd_options options_;
+};
+
+inline void semaphore_permit::release()
+{
+    if (auto * sem = std::exchange(sem_, nullptr))
+    {
+        if (std::uncaught_exceptions() > uncaught_count_)
+        {
+            sem->record_failure();
+        }
+        else
+        {
+            sem->record_success();
+        }
+        sem->release(count_);
+    }
+}
+
+}  // namespace scope_exit_v1
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,275 @@
+#pragma once
+
+/// Purpose: hand a block of memory to another process without copying it (Linux only).
+///
+/// A `shared_segment` is an anonymous `memfd_create` file mapped into the process.  The producer fills it inside a
+/// sealing scope: when the scope exits normally the writable mapping is dropped, the file is sealed against writes and
+/// resizing and mapped again read-only; when the scope is left by an exception the segment is torn down (unmapped and
+/// closed), so a half-written segment is never passed on.  The descriptor of a sealed segment can then be inherited
+/// over `fork` or sent with `SCM_RIGHTS`; the receiver attaches it and checks `sealed()`, after which nobody, the
+/// producer included, can change the bytes under it.  The mapping and the descriptor are released when the segment
+/// is destroyed, on every path.
+///
+/// `pages::huge` asks for hugetlb pages; without huge pages reserved on the system the segment falls back to normal
+/// pages and requests transparent huge pages for them instead.
+///
+/// Example:
+/// ```
+///   scope_exit_v1::shared_segment segment{frame_size, scope_exit_v1::shared_segment::pages::huge};
+///   {
+///       scope(sealed, segment);                        // sealed on success, torn down on failure
+///       render(static_cast<char *>(segment.data()), segment.size());
+///   }
+///   send_fd(socket, segment.fd());
+///
+///   // in the receiver
+///   auto frame = scope_exit_v1::shared_segment::attach(receive_fd(socket));
+///   if (!frame.sealed()) { ... }                       // the producer could still change it
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scope_exit_v1
+{
+
+class shared_segment
+{
+public:
+    enum class pages
+    {
+        normal,
+        huge,  // hugetlb if available, else normal pages with transparent huge pages requested
+    };
+
+    /// Seals the segment when the scope exits normally and tears it down when the scope is left by an exception.
+    class seal_guard
+    {
+    public:
+        explicit seal_guard(shared_segment & segment)
+            : segment_{segment}
+            , uncaught_count_{std::uncaught_exceptions()}
+        {}
+
+        seal_guard(seal_guard const &) = delete;
+        seal_guard & operator=(seal_guard const &) = delete;
+
+        ~seal_guard() noexcept(false)
+        {
+            if (std::uncaught_exceptions() > uncaught_count_)
+            {
+                segment_.reset();
+            }
+            else
+            {
+                segment_.seal();
+            }
+        }
+
+    private:
+        shared_segment & segment_;
+        int uncaught_count_;
+    };
+
+    /// Create a segment of `size` (> 0) bytes, mapped read-write.  `name` only shows up in /proc/<pid>/fd.
+    explicit shared_segment(std::size_t size, pages backing = pages::normal, char const * name = "scope_exit")
+        : size_{size}
+    {
+        if (backing == pages::huge && create(name, MFD_HUGETLB))
+        {
+            huge_ = true;
+            return;
+        }
+        if (!create(name, 0))
+        {
+            throw std::system_error(errno, std::system_category(), failed_call_);
+        }
+        if (backing == pages::huge)
+        {
+            static_cast<void>(::madvise(data_, mapped_, MADV_HUGEPAGE));
+        }
+    }
+
+    /// Take ownership of a segment descriptor received from another process.  It is mapped read-only if it is sealed
+    /// against writes and read-write otherwise; `size()` is the file size, whole huge pages for a hugetlb segment.
+    static shared_segment attach(int fd) { return shared_segment{fd}; }
+
+    shared_segment(shared_segment && other) noexcept
+        : fd_{std::exchange(other.fd_, -1)}
+        , data_{std::exchange(other.data_, nullptr)}
+        , size_{std::exchange(other.size_, 0)}
+        , mapped_{std::exchange(other.mapped_, 0)}
+        , huge_{other.huge_}
+        , sealed_{other.sealed_}
+    {}
+
+    shared_segment(shared_segment const &) = delete;
+    shared_segment & operator=(shared_segment const &) = delete;
+    shared_segment & operator=(shared_segment &&) = delete;
+
+    ~shared_segment() { reset(); }
+
+    /// The mapped bytes; read-only once sealed, null once torn down.
+    void * data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /// The descriptor to pass on; -1 once torn down.  It stays owned by the segment, pass a `dup` to keep it.
+    int fd() const { return fd_; }
+
+    bool huge_pages() const { return huge_; }
+
+    /// True if the contents can no longer change: the file is sealed against writes, resizing and further seals.
+    bool sealed() const { return sealed_; }
+
+    explicit operator bool() const { return fd_ >= 0; }
+
+    /// Seal the segment and map it again read-only.  Fails with EBUSY while a writable mapping of it exists elsewhere,
+    /// e.g. in a child forked before sealing.
+    void seal()
+    {
+        if (fd_ < 0 || sealed_)
+        {
+            return;
+        }
+        ::munmap(data_, mapped_);
+        data_ = nullptr;
+        if (::fcntl(fd_, F_ADD_SEALS, all_seals) != 0)
+        {
+            int const error = errno;
+            map(PROT_READ | PROT_WRITE);
+            throw std::system_error(error, std::system_category(), "fcntl(F_ADD_SEALS)");
+        }
+        sealed_ = true;
+        map(PROT_READ);
+    }
+
+    /// Unmap and close the segment.
+    void reset() noexcept
+    {
+        if (data_ != nullptr)
+        {
+            ::munmap(data_, mapped_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    static constexpr int all_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+
+    explicit shared_segment(int fd)
+        : fd_{fd}
+    {
+        struct stat st;
+        int const seals = ::fcntl(fd, F_GET_SEALS);
+        if (::fstat(fd, &st) != 0 || seals < 0)
+        {
+            int const error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::system_category(), "attach");
+        }
+        size_ = mapped_ = static_cast<std::size_t>(st.st_size);
+        sealed_ = (seals & all_seals) == all_seals;
+        if (size_ == 0)
+        {
+            return;
+        }
+        try
+        {
+            map((seals & F_SEAL_WRITE) != 0 ? PROT_READ : PROT_READ | PROT_WRITE);
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    // memfd_create + ftruncate + mmap; on failure leaves nothing open and errno and failed_call_ set.
+    bool create(char const * name, unsigned flags)
+    {
+        failed_call_ = "memfd_create";
+        fd_ = ::memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING | flags);
+        if (fd_ < 0)
+        {
+            return false;
+        }
+        mapped_ = size_;
+        if ((flags & MFD_HUGETLB) != 0)
+        {
+            // hugetlbfs reports its page size as the block size, and sizes must be multiples of it
+            struct stat st;
+            if (::fstat(fd_, &st) == 0 && st.st_blksize > 0)
+            {
+                std::size_t const huge_page = static_cast<std::size_t>(st.st_blksize);
+                mapped_ = (size_ + huge_page - 1) / huge_page * huge_page;
+            }
+        }
+        failed_call_ = "ftruncate";
+        if (::ftruncate(fd_, static_cast<off_t>(mapped_)) != 0)
+        {
+            return discard();
+        }
+        failed_call_ = "mmap";
+        data_ = ::mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data_ == MAP_FAILED)
+        {
+            data_ = nullptr;
+            return discard();
+        }
+        return true;
+    }
+
+    bool discard()
+    {
+        int const error = errno;
+        ::close(fd_);
+        fd_ = -1;
+        errno = error;
+        return false;
+    }
+
+    void map(int protection)
+    {
+        data_ = ::mmap(nullptr, mapped_, protection, MAP_SHARED, fd_, 0);
+        if (data_ == MAP_FAILED)
+        {
+            data_ = nullptr;
+            throw std::system_error(errno, std::system_category(), "mmap");
+        }
+    }
+
+    int fd_ = -1;
+    void * data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t mapped_ = 0;  // size_ rounded up to the huge page size
+    bool huge_ = false;
+    bool sealed_ = false;
+    char const * failed_call_ = nullptr;
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_sealed(segment)                                                                                          \
+    [[maybe_unused]] scope_exit_v1::shared_segment::seal_guard const SCOPE_CONCAT_(scope_sealed_obj_, __COUNTER__)(    \
+        segment)
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
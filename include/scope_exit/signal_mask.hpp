@@ -0,0 +1,195 @@
+#pragma once
+
+/// Purpose: block signals for the extent of a scope without a syscall pair per nested section (POSIX only).
+///
+/// The calling thread's signal mask is cached in user space the first time a guard runs.  A `signal_block_guard`
+/// calls `pthread_sigmask` only when some of the requested signals are not blocked yet, and restores the previous
+/// mask on every exit path.  Nested guards that ask for signals the outer guard has already blocked therefore cost
+/// nothing, so a stack of guards collapses into a single syscall pair.
+///
+/// The cache assumes that the mask is changed only through these guards.  Code that calls `pthread_sigmask` or
+/// `sigprocmask` directly should call `signal_mask::local().refresh()` afterwards.  For the same reason the guards
+/// must not be used inside signal handlers, which run with a mask the cache does not know about.
+///
+/// Example:
+/// ```
+///   void commit(journal & j)
+///   {
+///       scope(signals_blocked, SIGINT, SIGTERM);
+///       j.append(entry);
+///       j.flush();  // flush() blocks the same signals again at no cost
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <csignal>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <system_error>
+
+#include <pthread.h>
+
+namespace scope_exit_v1
+{
+
+/// Per-thread cache of the blocked signal set.  Signals are kept as a bitmask, bit `s - 1` for signal `s`.
+class signal_mask
+{
+public:
+    using mask_type = std::uint64_t;
+
+    static_assert(NSIG - 1 <= 64, "signal numbers do not fit in the mask");
+
+    static signal_mask & local()
+    {
+        static thread_local signal_mask mask;
+        return mask;
+    }
+
+    /// Signals currently blocked on the calling thread.
+    mask_type blocked()
+    {
+        if (!valid_)
+        {
+            refresh();
+        }
+        return blocked_;
+    }
+
+    /// Install `mask` as the thread's signal mask, skipping the syscall if it is already in effect.
+    void set(mask_type mask)
+    {
+        if (mask == blocked())
+        {
+            return;
+        }
+
+        sigset_t set = to_sigset(mask);
+        change_mask(SIG_SETMASK, &set, nullptr);
+        blocked_ = mask;
+    }
+
+    /// Re-read the mask from the kernel after it was changed behind the cache's back.
+    void refresh()
+    {
+        sigset_t set;
+        change_mask(SIG_BLOCK, nullptr, &set);
+        blocked_ = from_sigset(set);
+        valid_ = true;
+    }
+
+    /// Number of `pthread_sigmask` calls made through the cache on this thread.
+    std::uint64_t syscalls() const { return syscalls_; }
+
+    /// Mask bit for `signal`.  Throws `std::invalid_argument` unless 1 <= signal < NSIG.
+    static constexpr mask_type bit(int signal)
+    {
+        if (signal < 1 || signal >= NSIG)
+        {
+            throw std::invalid_argument("signal_mask: signal number out of range");
+        }
+        return mask_type{1} << (signal - 1);
+    }
+
+    /// Signals that can actually be blocked.  The kernel ignores requests for SIGKILL and SIGSTOP, and glibc those
+    /// for the two real-time signals it reserves, so they must not enter the cached mask.
+    static constexpr mask_type blockable = ~((mask_type{1} << (SIGKILL - 1)) | (mask_type{1} << (SIGSTOP - 1))
+#if defined(__GLIBC__)
+                                             | (mask_type{3} << 31)
+#endif
+                                                 );
+
+    static mask_type from_sigset(sigset_t const & set)
+    {
+        mask_type mask = 0;
+        for (int s = 1; s < NSIG; ++s)
+        {
+            if (sigismember(&set, s) == 1)
+            {
+                mask |= bit(s);
+            }
+        }
+        return mask;
+    }
+
+    static sigset_t to_sigset(mask_type mask)
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        for (int s = 1; mask != 0; ++s, mask >>= 1)
+        {
+            if (mask & 1)
+            {
+                sigaddset(&set, s);
+            }
+        }
+        return set;
+    }
+
+private:
+    signal_mask() = default;
+
+    void change_mask(int how, sigset_t const * set, sigset_t * old)
+    {
+        ++syscalls_;
+        if (int rc = ::pthread_sigmask(how, set, old); rc != 0)
+        {
+            throw std::system_error(rc, std::system_category(), "pthread_sigmask");
+        }
+    }
+
+    mask_type blocked_ = 0;
+    bool valid_ = false;
+    std::uint64_t syscalls_ = 0;
+};
+
+/// Blocks the given signals on the calling thread until the end of the scope.
+class signal_block_guard
+{
+public:
+    explicit signal_block_guard(std::initializer_list<int> signals)
+        : signal_block_guard(mask_of(signals), 0)
+    {}
+
+    explicit signal_block_guard(sigset_t const & signals)
+        : signal_block_guard(signal_mask::from_sigset(signals), 0)
+    {}
+
+    signal_block_guard(signal_block_guard const &) = delete;
+    signal_block_guard & operator=(signal_block_guard const &) = delete;
+
+    ~signal_block_guard() { signal_mask::local().set(previous_); }
+
+private:
+    signal_block_guard(signal_mask::mask_type signals, int)
+        : previous_{signal_mask::local().blocked()}
+    {
+        signal_mask::local().set(previous_ | (signals & signal_mask::blockable));
+    }
+
+    static signal_mask::mask_type mask_of(std::initializer_list<int> signals)
+    {
+        signal_mask::mask_type mask = 0;
+        for (int s : signals)
+        {
+            mask |= signal_mask::bit(s);
+        }
+        return mask;
+    }
+
+    signal_mask::mask_type previous_;
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_signals_blocked(...)                                                                                     \
+    [[maybe_unused]] scope_exit_v1::signal_block_guard const SCOPE_CONCAT_(scope_signal_block_guard_obj_,             \
+                                                                           __COUNTER__){{__VA_ARGS__}}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,265 @@
+#pragma once
+
+/// Purpose: allocation-free tracing spans bound to a scope.
+///
+/// `scope(span, "name");` pushes a span onto the calling thread's span stack, which lives in a preallocated
+/// per-thread buffer.  When the scope exits, the span gets its end timestamp and error status (set when the scope is
+/// left by an exception, the same detection `scope(failure)` uses) and is handed to the lock-free exporter queue.
+/// A consumer drains the queue with `span_exporter::drain()`, e.g. through `file_span_sink`.
+///
+/// Example:
+/// ```
+///   void handle(request const & r)
+///   {
+///       scope(span, "handle");
+///       parse(r);  // nested spans inside parse() get this span as parent
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+
+namespace scope_exit_v1
+{
+
+/// A completed span.
+struct span_record
+{
+    char const * name;
+    std::uint64_t id;
+    std::uint64_t parent_id;  // 0 for root spans
+    std::int64_t start_ns;    // steady clock
+    std::int64_t end_ns;
+    std::uint32_t depth;
+    bool failed;
+};
+
+/// Lock-free queue of completed spans shared by all threads.
+class span_exporter
+{
+public:
+    explicit span_exporter(std::size_t capacity)
+        : queue_{capacity}
+    {}
+
+    /// Process-wide exporter used by `scope(span)`.
+    static span_exporter & global()
+    {
+        static span_exporter exporter{1 << 16};
+        return exporter;
+    }
+
+    /// Enqueue a completed span.  Spans are dropped (and counted) when the queue is full.
+    void submit(span_record const & record)
+    {
+        if (!queue_.try_push(record))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// Pop every queued span and pass it to `sink`.  Returns the number of exported spans.
+    template <typename Sink>
+    std::size_t drain(Sink && sink)
+    {
+        std::size_t count = 0;
+        span_record record;
+        while (queue_.try_pop(record))
+        {
+            sink(record);
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    detail::mpmc_ring<span_record> queue_;
+    std::atomic<std::size_t> dropped_{0};
+};
+
+/// Exporter sink that writes one JSON object per line.
+class file_span_sink
+{
+public:
+    explicit file_span_sink(std::FILE * file)
+        : file_{file}
+    {}
+
+    void operator()(span_record const & r) const
+    {
+        std::fputs("{\"name\":\"", file_);
+        write_escaped(r.name);
+        std::fprintf(file_,
+                     "\",\"id\":%llu,\"parent\":%llu,\"start_ns\":%lld,\"end_ns\":%lld,\"depth\":%u,\"error\":%s}\n",
+                     static_cast<unsigned long long>(r.id), static_cast<unsigned long long>(r.parent_id),
+                     static_cast<long long>(r.start_ns), static_cast<long long>(r.end_ns), r.depth,
+                     r.failed ? "true" : "false");
+    }
+
+    /// Drain `exporter` into the file.
+    std::size_t flush(span_exporter & exporter = span_exporter::global())
+    {
+        auto count = exporter.drain(*this);
+        std::fflush(file_);
+        return count;
+    }
+
+private:
+    // Span names are arbitrary strings: escape quotes, backslashes and control characters as JSON requires.
+    void write_escaped(char const * text) const
+    {
+        for (auto const * c = text; c != nullptr && *c != '\0'; ++c)
+        {
+            auto const byte = static_cast<unsigned char>(*c);
+            char const * escape = nullptr;
+            switch (byte)
+            {
+            case '"':
+                escape = "\\\"";
+                break;
+            case '\\':
+                escape = "\\\\";
+                break;
+            case '\n':
+                escape = "\\n";
+                break;
+            case '\t':
+                escape = "\\t";
+                break;
+            default:
+                break;
+            }
+            if (escape != nullptr)
+            {
+                std::fputs(escape, file_);
+            }
+            else if (byte < 0x20)
+            {
+                std::fprintf(file_, "\\u%04x", byte);
+            }
+            else
+            {
+                std::fputc(byte, file_);
+            }
+        }
+    }
+
+    std::FILE * file_;
+};
+
+/// Per-thread stack of open spans.  Spans nested deeper than `capacity` are counted but not recorded.
+class span_stack
+{
+public:
+    static constexpr std::uint32_t capacity = 64;
+
+    static span_stack & local()
+    {
+        static thread_local span_stack stack;
+        return stack;
+    }
+
+    /// The innermost open span of the calling thread, or nullptr.
+    span_record const * current() const { return depth_ == 0 ? nullptr : &spans_[top()]; }
+
+    std::uint32_t depth() const { return depth_; }
+
+    std::size_t overflowed() const { return overflowed_; }
+
+    void push(char const * name)
+    {
+        if (depth_ < capacity)
+        {
+            auto & s = spans_[depth_];
+            s.name = name;
+            s.id = (thread_tag_ << 32) | ++sequence_;
+            s.parent_id = depth_ == 0 ? 0 : spans_[depth_ - 1].id;
+            s.depth = depth_;
+            s.failed = false;
+            s.start_ns = now_ns();
+        }
+        else
+        {
+            ++overflowed_;
+        }
+        ++depth_;
+    }
+
+    void pop(bool failed, span_exporter & exporter)
+    {
+        --depth_;
+        if (depth_ < capacity)
+        {
+            auto & s = spans_[depth_];
+            s.end_ns = now_ns();
+            s.failed = failed;
+            exporter.submit(s);
+        }
+    }
+
+private:
+    span_stack()
+        : thread_tag_{next_thread_tag()}
+    {}
+
+    std::uint32_t top() const { return (depth_ < capacity ? depth_ : capacity) - 1; }
+
+    static std::uint64_t next_thread_tag()
+    {
+        static std::atomic<std::uint32_t> tags{0};
+        return tags.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static std::int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    span_record spans_[capacity];
+    std::uint32_t depth_ = 0;
+    std::uint64_t thread_tag_;
+    std::uint64_t sequence_ = 0;
+    std::size_t overflowed_ = 0;
+};
+
+/// Scope-bound span on the calling thread's span stack.
+class span_guard
+{
+public:
+    explicit span_guard(char const * name, span_exporter & exporter = span_exporter::global())
+        : exporter_{exporter}
+        , uncaught_count_{std::uncaught_exceptions()}
+    {
+        span_stack::local().push(name);
+    }
+
+    span_guard(span_guard const &) = delete;
+    span_guard & operator=(span_guard const &) = delete;
+
+    ~span_guard() { span_stack::local().pop(std::uncaught_exceptions() > uncaught_count_, exporter_); }
+
+private:
+    span_exporter & exporter_;
+    int uncaught_count_;
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_span(...)                                                                                                \
+    [[maybe_unused]] scope_exit_v1::span_guard const SCOPE_CONCAT_(scope_span_guard_obj_, __COUNTER__){__VA_ARGS__}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
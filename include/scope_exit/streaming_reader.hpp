@@ -0,0 +1,304 @@
+#pragma once
+
+/// Purpose: read a file once without pushing everything else out of the page cache (Linux).
+///
+/// A `streaming_reader` hints sequential access on the file when it is created (`POSIX_FADV_SEQUENTIAL`, which
+/// doubles the readahead window), records the byte ranges read through it and, when the scope ends, tells the kernel
+/// it does not need those pages any more (`POSIX_FADV_DONTNEED`).  Given a byte budget it also drops what it has read
+/// every time the budget fills up, so a job streaming a 100 GB file keeps at most about that much of it cached at a
+/// time instead of evicting the working set of its neighbours.
+///
+/// The reader counts exactly the bytes its `read()` and `pread()` returned; reads made some other way are recorded
+/// with `note_read()`.  Moving the file offset is not reading, so a forward `lseek` between reads drops nothing.
+/// DONTNEED only evicts clean pages, and it evicts them for every process: pages another process had cached before
+/// the reader read them are dropped as well.
+///
+/// `scope(streaming, fd)` is for code that reads the descriptor itself, out of the reader's sight.  Its guard takes
+/// the span the file offset advanced over during the scope as read, but leaves alone every page of it that was
+/// cached already when the scope began; so pages skipped by a forward seek, and pages other processes use, stay as
+/// they were.  Finding the cached pages costs a `mincore()` call over the rest of the file and a byte per page.
+/// Advice that fails (pipes, sockets) is ignored; read errors throw `std::system_error`.
+///
+/// Example:
+/// ```
+///   void checksum(int fd)
+///   {
+///       scope_exit_v1::streaming_reader reader{fd, 64 << 20};  // drop every 64 MiB read
+///       char buffer[1 << 16];
+///       while (auto n = reader.read(buffer, sizeof buffer))
+///       {
+///           hash.update(buffer, n);
+///       }
+///   }
+///
+///   void import(int fd)
+///   {
+///       scope(streaming, fd);  // drop what parse() brings into the cache from fd
+///       parse(fd);
+///   }
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scope_exit_v1
+{
+namespace detail
+{
+
+inline off_t page_size()
+{
+    static off_t const size = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+inline void advise(int fd, off_t offset, off_t length, int advice)
+{
+    static_cast<void>(::posix_fadvise(fd, offset, length, advice));
+}
+
+}  // namespace detail
+
+class streaming_reader
+{
+public:
+    /// Track reads of `fd`, which stays owned by the caller.  With `drop_every` > 0, what has been read through the
+    /// reader is dropped each time that many bytes have accumulated; otherwise only when the reader is destroyed.
+    explicit streaming_reader(int fd, std::size_t drop_every = 0)
+        : fd_{fd}
+        , drop_every_{drop_every}
+    {
+        detail::advise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    streaming_reader(streaming_reader const &) = delete;
+    streaming_reader & operator=(streaming_reader const &) = delete;
+
+    ~streaming_reader()
+    {
+        drop_ranges(true);
+        detail::advise(fd_, 0, 0, POSIX_FADV_NORMAL);
+    }
+
+    /// `read(2)` at the current offset, retried on EINTR.  Returns 0 at the end of the file.
+    std::size_t read(void * buffer, std::size_t size)
+    {
+        off_t const offset = ::lseek(fd_, 0, SEEK_CUR);
+        ssize_t n;
+        while ((n = ::read(fd_, buffer, size)) < 0)
+        {
+            if (errno != EINTR)
+            {
+                throw std::system_error(errno, std::system_category(), "read");
+            }
+        }
+        if (offset >= 0)
+        {
+            note_read(offset, static_cast<std::size_t>(n));
+        }
+        return static_cast<std::size_t>(n);
+    }
+
+    /// `pread(2)`, retried on EINTR.  Returns 0 at the end of the file.
+    std::size_t pread(void * buffer, std::size_t size, off_t offset)
+    {
+        ssize_t n;
+        while ((n = ::pread(fd_, buffer, size, offset)) < 0)
+        {
+            if (errno != EINTR)
+            {
+                throw std::system_error(errno, std::system_category(), "pread");
+            }
+        }
+        note_read(offset, static_cast<std::size_t>(n));
+        return static_cast<std::size_t>(n);
+    }
+
+    /// Record a read made some other way, e.g. through a mapping of the file.
+    void note_read(off_t offset, std::size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        track(offset, offset + static_cast<off_t>(size));
+        bytes_read_ += size;
+        pending_ += size;
+        if (drop_every_ != 0 && pending_ >= drop_every_)
+        {
+            drop_ranges(false);
+        }
+    }
+
+    /// Drop the whole pages read so far.  A partly read last page of a range stays tracked until it is read to
+    /// the end or the reader is destroyed.
+    void drop() { drop_ranges(false); }
+
+    std::uint64_t bytes_read() const { return bytes_read_; }
+
+    /// Bytes covered by DONTNEED advice so far, in whole pages.
+    std::uint64_t bytes_dropped() const { return bytes_dropped_; }
+
+    /// Disjoint ranges [first, second) read and not dropped yet.
+    std::vector<std::pair<off_t, off_t>> const & pending_ranges() const { return ranges_; }
+
+private:
+    // Insert [begin, end), merging it with the ranges it overlaps or touches.  Streaming reads extend the last range.
+    void track(off_t begin, off_t end)
+    {
+        if (!ranges_.empty() && ranges_.back().second == begin)
+        {
+            ranges_.back().second = end;
+            return;
+        }
+        auto it = std::lower_bound(ranges_.begin(), ranges_.end(), begin,
+                                   [](std::pair<off_t, off_t> const & r, off_t b) { return r.second < b; });
+        auto last = it;
+        while (last != ranges_.end() && last->first <= end)
+        {
+            begin = std::min(begin, last->first);
+            end = std::max(end, last->second);
+            ++last;
+        }
+        it = ranges_.erase(it, last);
+        ranges_.insert(it, {begin, end});
+    }
+
+    // Allocates only when `final` is false, so the destructor cannot throw.
+    void drop_ranges(bool final)
+    {
+        off_t const page = detail::page_size();
+        std::vector<std::pair<off_t, off_t>> kept;
+        for (auto const & [begin, end] : ranges_)
+        {
+            off_t const from = begin / page * page;
+            off_t const to = final ? (end + page - 1) / page * page : end / page * page;
+            if (to > from)
+            {
+                detail::advise(fd_, from, to - from, POSIX_FADV_DONTNEED);
+                bytes_dropped_ += static_cast<std::uint64_t>(to - from);
+            }
+            if (!final && to < end)
+            {
+                kept.emplace_back(std::max(begin, to), end);
+            }
+        }
+        ranges_ = std::move(kept);
+        pending_ = 0;
+    }
+
+    int fd_;
+    std::size_t drop_every_;
+    std::vector<std::pair<off_t, off_t>> ranges_;
+    std::size_t pending_ = 0;
+    std::uint64_t bytes_read_ = 0;
+    std::uint64_t bytes_dropped_ = 0;
+};
+
+/// Guard behind `scope(streaming, fd)`: drops the pages of the span the file offset advanced over during the scope,
+/// except the ones that were cached when the scope began.
+class streaming_guard
+{
+public:
+    explicit streaming_guard(int fd)
+        : fd_{fd}
+        , start_{::lseek(fd, 0, SEEK_CUR)}
+    {
+        detail::advise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (start_ >= 0)
+        {
+            record_cached();
+        }
+    }
+
+    streaming_guard(streaming_guard const &) = delete;
+    streaming_guard & operator=(streaming_guard const &) = delete;
+
+    ~streaming_guard()
+    {
+        off_t const end = ::lseek(fd_, 0, SEEK_CUR);
+        if (start_ >= 0 && end > start_)
+        {
+            drop(end);
+        }
+        detail::advise(fd_, 0, 0, POSIX_FADV_NORMAL);
+    }
+
+private:
+    // Without a mapping (an empty file, or one that cannot be mapped) no page counts as cached.
+    void record_cached()
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size <= start_)
+        {
+            return;
+        }
+        off_t const page = detail::page_size();
+        off_t const first = start_ / page * page;
+        auto const length = static_cast<std::size_t>(st.st_size - first);
+        std::vector<unsigned char> cached(static_cast<std::size_t>((st.st_size - first + page - 1) / page));
+
+        void * map = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, first);
+        if (map == MAP_FAILED)
+        {
+            return;
+        }
+        bool const ok = ::mincore(map, length, cached.data()) == 0;
+        ::munmap(map, length);
+        if (ok)
+        {
+            cached_ = std::move(cached);
+        }
+    }
+
+    bool was_cached(std::size_t page_index) const { return page_index < cached_.size() && (cached_[page_index] & 1); }
+
+    // Advise DONTNEED over each run of pages in [start_, end) that was not cached at the start.  Does not allocate.
+    void drop(off_t end)
+    {
+        off_t const page = detail::page_size();
+        off_t const first = start_ / page * page;
+        auto const pages = static_cast<std::size_t>((end - first + page - 1) / page);
+        std::size_t run = 0;
+        for (std::size_t i = 0; i <= pages; ++i)
+        {
+            if (i != pages && !was_cached(i))
+            {
+                continue;
+            }
+            if (i > run)
+            {
+                detail::advise(fd_, first + static_cast<off_t>(run) * page, static_cast<off_t>(i - run) * page,
+                               POSIX_FADV_DONTNEED);
+            }
+            run = i + 1;
+        }
+    }
+
+    int fd_;
+    off_t start_;  // file offset when the scope began; -1 if the file has none
+    std::vector<unsigned char> cached_;  // mincore() bits of the pages from start_ to the end of the file
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_streaming(fd)                                                                                            \
+    [[maybe_unused]] scope_exit_v1::streaming_guard const SCOPE_CONCAT_(scope_streaming_obj_, __COUNTER__){fd}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
@@ -0,0 +1,276 @@
+#pragma once
+
+/// Purpose: tell whether a slow scope is blocked or burning CPU (POSIX).
+///
+/// `scope(timed);` reads the monotonic clock and the calling thread's CPU clock (`CLOCK_THREAD_CPUTIME_ID`) when it
+/// is created and when the scope exits.  Per site it accumulates wall time and on-CPU time; the difference is the
+/// time the thread spent off the CPU: sleeping, waiting for I/O or a lock, or preempted.  On every n-th timed scope of
+/// a thread (`SCOPE_EXIT_TIMED_SAMPLE`, default 16, or `timed::set_sample_period`) the guard also reads
+/// `getrusage(RUSAGE_THREAD)` to count the voluntary and involuntary context switches inside the scope.
+///
+/// The monotonic clock is served by the vDSO on Linux; the thread CPU clock is not, so each timed scope costs two
+/// system calls.  Time it coarse operations (requests, queries, file loads) rather than inner loops.
+///
+/// Example:
+/// ```
+///   void load(std::string const & path)
+///   {
+///       scope(timed);
+///       parse(read_file(path));
+///   }
+///
+///   scope_exit_v1::timed::report(stderr);
+///   // site                        count    wall ms  on-cpu ms off-cpu ms  max ms  vol.cs/call
+///   // loader.cpp:12                  40     812.4      95.1      717.3    61.0        3.2
+/// ```
+
+#include <scope_exit/scope_exit.hpp>
+#include <scope_exit/detail/mpmc_ring.hpp>
+#include <scope_exit/detail/shard_hint.hpp>
+#include <scope_exit/detail/site_list.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+
+#if !defined(SCOPE_EXIT_TIMED_SAMPLE)
+#define SCOPE_EXIT_TIMED_SAMPLE 16
+#endif
+
+namespace scope_exit_v1
+{
+
+/// Accumulated times of one `scope(timed)` site at the time `timed::sites()` was called.
+struct timed_stats
+{
+    char const * file;
+    int line;
+    unsigned id;  // `__COUNTER__` value of the macro use
+    std::uint64_t count;
+    std::uint64_t wall_ns;
+    std::uint64_t cpu_ns;
+    std::uint64_t max_wall_ns;
+    std::uint64_t sampled;  // scopes that also counted context switches
+    std::uint64_t voluntary_switches;
+    std::uint64_t involuntary_switches;
+
+    std::uint64_t off_cpu_ns() const { return wall_ns > cpu_ns ? wall_ns - cpu_ns : 0; }
+};
+
+/// Accumulators of one `scope(timed)` site, sharded like `instrument_site`.
+class timed_site
+{
+public:
+    static constexpr unsigned shards = 8;
+
+    constexpr timed_site(char const * file, int line, unsigned id)
+        : file_{file}
+        , line_{line}
+        , id_{id}
+    {}
+
+    timed_site(timed_site const &) = delete;
+    timed_site & operator=(timed_site const &) = delete;
+
+    void record(std::uint64_t wall_ns, std::uint64_t cpu_ns)
+    {
+        detail::site_list<timed_site>::add(*this);
+
+        auto & s = shards_[detail::thread_shard_hint() % shards];
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        s.wall_ns.fetch_add(wall_ns, std::memory_order_relaxed);
+        s.cpu_ns.fetch_add(cpu_ns, std::memory_order_relaxed);
+        auto max = max_wall_ns_.load(std::memory_order_relaxed);
+        while (wall_ns > max && !max_wall_ns_.compare_exchange_weak(max, wall_ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void record_switches(std::uint64_t voluntary, std::uint64_t involuntary)
+    {
+        auto & s = shards_[detail::thread_shard_hint() % shards];
+        s.sampled.fetch_add(1, std::memory_order_relaxed);
+        s.voluntary.fetch_add(voluntary, std::memory_order_relaxed);
+        s.involuntary.fetch_add(involuntary, std::memory_order_relaxed);
+    }
+
+    timed_stats stats() const
+    {
+        timed_stats r{file_, line_, id_, 0, 0, 0, max_wall_ns_.load(std::memory_order_relaxed), 0, 0, 0};
+        for (auto const & s : shards_)
+        {
+            r.count += s.count.load(std::memory_order_relaxed);
+            r.wall_ns += s.wall_ns.load(std::memory_order_relaxed);
+            r.cpu_ns += s.cpu_ns.load(std::memory_order_relaxed);
+            r.sampled += s.sampled.load(std::memory_order_relaxed);
+            r.voluntary_switches += s.voluntary.load(std::memory_order_relaxed);
+            r.involuntary_switches += s.involuntary.load(std::memory_order_relaxed);
+        }
+        return r;
+    }
+
+    void reset()
+    {
+        for (auto & s : shards_)
+        {
+            s.count.store(0, std::memory_order_relaxed);
+            s.wall_ns.store(0, std::memory_order_relaxed);
+            s.cpu_ns.store(0, std::memory_order_relaxed);
+            s.sampled.store(0, std::memory_order_relaxed);
+            s.voluntary.store(0, std::memory_order_relaxed);
+            s.involuntary.store(0, std::memory_order_relaxed);
+        }
+        max_wall_ns_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    friend class detail::site_list<timed_site>;
+
+    struct alignas(detail::cache_line_size) shard
+    {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> wall_ns{0};
+        std::atomic<std::uint64_t> cpu_ns{0};
+        std::atomic<std::uint64_t> sampled{0};
+        std::atomic<std::uint64_t> voluntary{0};
+        std::atomic<std::uint64_t> involuntary{0};
+    };
+
+    char const * file_;
+    int line_;
+    unsigned id_;
+    std::atomic<bool> registered_{false};
+    timed_site * next_ = nullptr;
+    std::atomic<std::uint64_t> max_wall_ns_{0};
+    shard shards_[shards];
+};
+
+/// Registry of the `scope(timed)` sites entered so far.
+class timed
+{
+public:
+    /// Snapshot of every site timed so far, most recently registered first.
+    static std::vector<timed_stats> sites()
+    {
+        std::vector<timed_stats> result;
+        detail::site_list<timed_site>::for_each([&](timed_site const & s) { result.push_back(s.stats()); });
+        return result;
+    }
+
+    /// Print one line per site, most off-CPU time first.
+    static void report(std::FILE * out)
+    {
+        auto all = sites();
+        std::sort(all.begin(), all.end(),
+                  [](timed_stats const & a, timed_stats const & b) { return a.off_cpu_ns() > b.off_cpu_ns(); });
+        std::fprintf(out, "%-40s %10s %12s %12s %12s %10s %12s\n", "site", "count", "wall ms", "on-cpu ms",
+                     "off-cpu ms", "max ms", "vol.cs/call");
+        for (auto const & s : all)
+        {
+            char where[256];
+            std::snprintf(where, sizeof where, "%s:%d", s.file, s.line);
+            double switches = s.sampled != 0 ? static_cast<double>(s.voluntary_switches) / s.sampled : 0.0;
+            std::fprintf(out, "%-40s %10llu %12.3f %12.3f %12.3f %10.3f %12.2f\n", where,
+                         static_cast<unsigned long long>(s.count), s.wall_ns / 1e6, s.cpu_ns / 1e6,
+                         s.off_cpu_ns() / 1e6, s.max_wall_ns / 1e6, switches);
+        }
+    }
+
+    static void reset()
+    {
+        detail::site_list<timed_site>::for_each([](timed_site & s) { s.reset(); });
+    }
+
+    /// Count context switches in every `period`-th timed scope of each thread; 0 turns it off.
+    static void set_sample_period(std::uint32_t period) { sample_period().store(period, std::memory_order_relaxed); }
+
+private:
+    friend class timed_guard;
+
+    static std::atomic<std::uint32_t> & sample_period()
+    {
+        static std::atomic<std::uint32_t> period{SCOPE_EXIT_TIMED_SAMPLE};
+        return period;
+    }
+};
+
+/// Times the rest of the enclosing scope into `site`.
+class timed_guard
+{
+public:
+    explicit timed_guard(timed_site & site)
+        : site_{site}
+        , sampled_{timed::sample_period().load(std::memory_order_relaxed) != 0
+                   && detail::sample_tick<timed>(timed::sample_period())}
+    {
+        if (sampled_)
+        {
+            switches(start_voluntary_, start_involuntary_);
+        }
+        start_wall_ = now(CLOCK_MONOTONIC);
+        start_cpu_ = now(CLOCK_THREAD_CPUTIME_ID);
+    }
+
+    timed_guard(timed_guard const &) = delete;
+    timed_guard & operator=(timed_guard const &) = delete;
+
+    ~timed_guard()
+    {
+        auto cpu = now(CLOCK_THREAD_CPUTIME_ID) - start_cpu_;
+        auto wall = now(CLOCK_MONOTONIC) - start_wall_;
+        site_.record(wall, std::min(cpu, wall));
+        if (sampled_)
+        {
+            long voluntary;
+            long involuntary;
+            switches(voluntary, involuntary);
+            site_.record_switches(static_cast<std::uint64_t>(voluntary - start_voluntary_),
+                                  static_cast<std::uint64_t>(involuntary - start_involuntary_));
+        }
+    }
+
+private:
+    static std::uint64_t now(clockid_t clock)
+    {
+        timespec ts;
+        ::clock_gettime(clock, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000u + static_cast<std::uint64_t>(ts.tv_nsec);
+    }
+
+    static void switches(long & voluntary, long & involuntary)
+    {
+        rusage usage{};
+#if defined(RUSAGE_THREAD)
+        ::getrusage(RUSAGE_THREAD, &usage);
+#else
+        ::getrusage(RUSAGE_SELF, &usage);
+#endif
+        voluntary = usage.ru_nvcsw;
+        involuntary = usage.ru_nivcsw;
+    }
+
+    timed_site & site_;
+    bool sampled_;
+    long start_voluntary_ = 0;
+    long start_involuntary_ = 0;
+    std::uint64_t start_wall_;
+    std::uint64_t start_cpu_;
+};
+
+}  // namespace scope_exit_v1
+
+#define scope_timed SCOPE_TIMED_(__COUNTER__)
+#define SCOPE_TIMED_(id)                                                                                               \
+    static scope_exit_v1::timed_site SCOPE_CONCAT_(scope_timed_site_, id)(__FILE__, __LINE__, id);                     \
+    scope_exit_v1::timed_guard const SCOPE_CONCAT_(scope_timed_obj_, id){SCOPE_CONCAT_(scope_timed_site_, id)}
+
+// Copyright Alexei Zakharov, 2025.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
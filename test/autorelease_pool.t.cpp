@@ -0,0 +1,178 @@
+#include <scope_exit/autorelease_pool.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using scope_exit_v1::autorelease_pool;
+
+namespace
+{
+
+struct tracked
+{
+    tracked(std::vector<int> & log, int id)
+        : log_{log}
+        , id_{id}
+    {}
+
+    ~tracked() { log_.push_back(id_); }
+
+    std::vector<int> & log_;
+    int id_;
+};
+
+struct throwing
+{
+    throwing() { throw std::runtime_error("ctor"); }
+};
+
+struct base
+{
+    virtual ~base() = default;
+};
+
+struct derived : base
+{
+    derived(int & destroyed)
+        : destroyed_{destroyed}
+    {}
+
+    ~derived() override { ++destroyed_; }
+
+    std::string payload = std::string(100, 'x');
+    int & destroyed_;
+};
+
+struct alignas(2 * __STDCPP_DEFAULT_NEW_ALIGNMENT__) over_aligned
+{
+    over_aligned(int & destroyed)
+        : destroyed_{destroyed}
+    {}
+
+    ~over_aligned() { ++destroyed_; }
+
+    int & destroyed_;
+};
+
+}  // namespace
+
+TEST_CASE("autorelease_pool destroys objects at scope exit", "[autorelease_pool][basic]")
+{
+    std::vector<int> log;
+
+    SECTION("reverse order of registration")
+    {
+        {
+            autorelease_pool pool;
+            pool.make<tracked>(log, 1);
+            pool.make<tracked>(log, 2);
+            pool.adopt(new tracked{log, 3});
+            REQUIRE(pool.size() == 3);
+            REQUIRE(log.empty());
+        }
+        REQUIRE(log == std::vector<int>{3, 2, 1});
+    }
+
+    SECTION("more objects than the inline chunk")
+    {
+        constexpr int count = autorelease_pool::inline_capacity + 2 * autorelease_pool::chunk_capacity + 5;
+        {
+            autorelease_pool pool;
+            for (int i = 0; i != count; ++i)
+            {
+                pool.make<tracked>(log, i);
+            }
+            REQUIRE(pool.size() == count);
+        }
+        REQUIRE(log.size() == count);
+        for (int i = 0; i != count; ++i)
+        {
+            REQUIRE(log[i] == count - 1 - i);
+        }
+    }
+
+    SECTION("objects are released on exception")
+    {
+        try
+        {
+            autorelease_pool pool;
+            pool.make<tracked>(log, 1);
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(log == std::vector<int>{1});
+    }
+
+    SECTION("throwing constructor leaves the pool unchanged")
+    {
+        autorelease_pool pool;
+        pool.make<tracked>(log, 1);
+        REQUIRE_THROWS_AS(pool.make<throwing>(), std::runtime_error);
+        REQUIRE(pool.size() == 1);
+        pool.make<tracked>(log, 2);
+        pool.drain();
+        REQUIRE(log == std::vector<int>{2, 1});
+        REQUIRE(pool.size() == 0);
+    }
+
+    SECTION("trivial and polymorphic objects")
+    {
+        int destroyed = 0;
+        {
+            autorelease_pool pool;
+            int * value = pool.make<int>(42);
+            REQUIRE(*value == 42);
+            base * b = pool.adopt<base>(new derived{destroyed});
+            REQUIRE(b != nullptr);
+        }
+        REQUIRE(destroyed == 1);
+    }
+
+    SECTION("over-aligned adopted objects")
+    {
+        int destroyed = 0;
+        {
+            autorelease_pool pool;
+            for (int i = 0; i != 4; ++i)
+            {
+                auto * o = pool.adopt(new over_aligned{destroyed});
+                REQUIRE(reinterpret_cast<std::uintptr_t>(o) % alignof(over_aligned) == 0);
+            }
+        }
+        REQUIRE(destroyed == 4);
+    }
+}
+
+TEST_CASE("nested autorelease pools", "[autorelease_pool][nested]")
+{
+    std::vector<int> log;
+    REQUIRE(autorelease_pool::current() == nullptr);
+
+    {
+        autorelease_pool outer;
+        REQUIRE(autorelease_pool::current() == &outer);
+        scope_exit_v1::autorelease_new<tracked>(log, 1);
+
+        {
+            autorelease_pool inner;
+            REQUIRE(autorelease_pool::current() == &inner);
+            REQUIRE(inner.parent() == &outer);
+            scope_exit_v1::autorelease_new<tracked>(log, 2);
+            scope_exit_v1::autorelease(new tracked{log, 3});
+            REQUIRE(inner.size() == 2);
+            REQUIRE(outer.size() == 1);
+        }
+
+        REQUIRE(log == std::vector<int>{3, 2});
+        REQUIRE(autorelease_pool::current() == &outer);
+    }
+
+    REQUIRE(log == std::vector<int>{3, 2, 1});
+    REQUIRE(autorelease_pool::current() == nullptr);
+}
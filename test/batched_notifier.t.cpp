@@ -0,0 +1,205 @@
+#include <scope_exit/batched_notifier.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+using scope_exit_v1::batched_notifier;
+
+namespace
+{
+
+bool readable(batched_notifier const & notifier)
+{
+    pollfd p{notifier.fd(), POLLIN, 0};
+    return ::poll(&p, 1, 0) == 1 && (p.revents & POLLIN) != 0;
+}
+
+void notify_nested(batched_notifier & notifier, int messages)
+{
+    scope(notify_batch, notifier);
+    for (int i = 0; i != messages; ++i)
+    {
+        notifier.notify();
+    }
+}
+
+}  // namespace
+
+TEST_CASE("batched_notifier coalesces notifications", "[batched_notifier][basic]")
+{
+    batched_notifier notifier;
+    REQUIRE_FALSE(readable(notifier));
+
+    SECTION("without a batch every notification is a write")
+    {
+        notifier.notify();
+        notifier.notify(2);
+        REQUIRE(notifier.writes() == 2);
+        REQUIRE(readable(notifier));
+        REQUIRE(notifier.consume() == 3);
+        REQUIRE_FALSE(readable(notifier));
+        REQUIRE(notifier.consume() == 0);
+    }
+
+    SECTION("a batch writes once when it exits")
+    {
+        {
+            scope(notify_batch, notifier);
+            for (int i = 0; i != 10; ++i)
+            {
+                notifier.notify();
+            }
+            REQUIRE_FALSE(readable(notifier));
+        }
+        REQUIRE(notifier.writes() == 1);
+        REQUIRE(notifier.wait(0) == 10);
+    }
+
+    SECTION("nested batches fold into the outermost")
+    {
+        {
+            batched_notifier::batch outer{notifier};
+            notifier.notify();
+            notify_nested(notifier, 5);
+            REQUIRE(notifier.writes() == 0);
+            REQUIRE(outer.pending() == 6);
+        }
+        REQUIRE(notifier.writes() == 1);
+        REQUIRE(notifier.consume() == 6);
+    }
+
+    SECTION("an empty batch does not write")
+    {
+        {
+            scope(notify_batch, notifier);
+        }
+        REQUIRE(notifier.writes() == 0);
+    }
+
+    SECTION("a batch flushes when left by an exception")
+    {
+        try
+        {
+            scope(notify_batch, notifier);
+            notifier.notify(4);
+            throw std::runtime_error("producer failed");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(notifier.writes() == 1);
+        REQUIRE(notifier.consume() == 4);
+    }
+}
+
+TEST_CASE("batched_notifier counts only successful writes", "[batched_notifier][basic]")
+{
+    batched_notifier notifier;
+    notifier.notify(0xfffffffffffffffe);  // the largest count an eventfd holds
+    notifier.notify();                    // EAGAIN: the counter is full
+    REQUIRE(notifier.writes() == 1);
+    REQUIRE(notifier.consume() == 0xfffffffffffffffe);
+}
+
+TEST_CASE("batched_notifier wait returns 0 only on timeout", "[batched_notifier][wait]")
+{
+    batched_notifier notifier;
+
+    SECTION("a timed wait without notifications lasts the timeout")
+    {
+        auto const start = std::chrono::steady_clock::now();
+        REQUIRE(notifier.wait(20) == 0);
+        REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{20});
+    }
+
+    SECTION("a wait woken for notifications another consumer took keeps waiting")
+    {
+        for (int round = 0; round != 100; ++round)
+        {
+            std::atomic<std::uint64_t> got{0};
+            std::thread waiter([&] { got = notifier.wait(); });
+            notifier.notify();
+            notifier.consume();  // races with the waiter for the notification
+            notifier.notify(2);
+            waiter.join();
+            REQUIRE(got.load() != 0);
+            notifier.consume();
+        }
+    }
+}
+
+TEST_CASE("batches of different notifiers are independent", "[batched_notifier][nesting]")
+{
+    batched_notifier a;
+    batched_notifier b;
+    {
+        scope(notify_batch, a);
+        {
+            scope(notify_batch, b);
+            a.notify();
+            b.notify();
+            notify_nested(a, 2);
+        }
+        REQUIRE(b.writes() == 1);
+        REQUIRE(a.writes() == 0);
+        b.notify();  // b's batch is closed
+        REQUIRE(b.writes() == 2);
+    }
+    REQUIRE(a.writes() == 1);
+    REQUIRE(a.consume() == 3);
+    REQUIRE(b.consume() == 2);
+}
+
+TEST_CASE("batched_notifier wakes a polling consumer once per batch", "[batched_notifier][threads]")
+{
+    constexpr int producers = 4;
+    constexpr int batches = 50;
+    constexpr int batch_size = 20;
+    constexpr std::uint64_t expected = std::uint64_t{producers} * batches * batch_size;
+
+    batched_notifier notifier;
+    std::atomic<std::uint64_t> received{0};
+    std::atomic<int> wakeups{0};
+    std::thread consumer([&] {
+        while (received.load() != expected)
+        {
+            if (auto n = notifier.wait(1000))
+            {
+                received += n;
+                ++wakeups;
+            }
+        }
+    });
+
+    std::vector<std::thread> pool;
+    for (int p = 0; p != producers; ++p)
+    {
+        pool.emplace_back([&] {
+            for (int b = 0; b != batches; ++b)
+            {
+                scope(notify_batch, notifier);
+                for (int i = 0; i != batch_size; ++i)
+                {
+                    notifier.notify();
+                }
+            }
+        });
+    }
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+    consumer.join();
+
+    CHECK(received.load() == expected);
+    CHECK(notifier.writes() == producers * batches);
+    CHECK(wakeups.load() <= producers * batches);
+}
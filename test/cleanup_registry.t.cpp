@@ -0,0 +1,192 @@
+#include <scope_exit/cleanup_registry.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using scope_exit_v1::cleanup_registry;
+using scope_exit_v1::coalesce;
+
+TEST_CASE("cleanup_registry coalesces duplicate keys", "[cleanup_registry][basic]")
+{
+    std::map<int, int> flushes;
+    int files[3] = {};
+
+    SECTION("one execution per key")
+    {
+        {
+            cleanup_registry<> cleanups;
+            for (int i = 0; i != 30; ++i)
+            {
+                int & f = files[i % 3];
+                cleanups.defer(&f, [&] { ++flushes[static_cast<int>(&f - files)]; });
+            }
+            REQUIRE(cleanups.size() == 3);
+            REQUIRE(flushes.empty());
+        }
+        REQUIRE(flushes == std::map<int, int>{{0, 1}, {1, 1}, {2, 1}});
+    }
+
+    SECTION("defer reports new keys")
+    {
+        cleanup_registry<> cleanups;
+        REQUIRE(cleanups.defer(1, [] {}));
+        REQUIRE_FALSE(cleanups.defer(1, [] {}));
+        REQUIRE(cleanups.contains(1));
+        REQUIRE_FALSE(cleanups.contains(2));
+    }
+
+    SECTION("keys run in reverse order of first registration")
+    {
+        std::vector<int> order;
+        {
+            cleanup_registry<> cleanups;
+            cleanups.defer(1, [&] { order.push_back(1); });
+            cleanups.defer(2, [&] { order.push_back(2); });
+            cleanups.defer(1, [&] { order.push_back(-1); });
+            cleanups.defer(3, [&] { order.push_back(3); });
+        }
+        REQUIRE(order == std::vector<int>{3, 2, 1});
+    }
+}
+
+TEST_CASE("cleanup_registry policies", "[cleanup_registry][policy]")
+{
+    std::vector<std::string> log;
+
+    SECTION("first registration wins")
+    {
+        {
+            cleanup_registry<coalesce::first_wins> cleanups;
+            cleanups.defer(7, [&] { log.push_back("first"); });
+            cleanups.defer(7, [&] { log.push_back("second"); });
+        }
+        REQUIRE(log == std::vector<std::string>{"first"});
+    }
+
+    SECTION("last registration wins")
+    {
+        {
+            cleanup_registry<coalesce::last_wins> cleanups;
+            cleanups.defer(7, [&] { log.push_back("first"); });
+            cleanups.defer(7, [&] { log.push_back("second"); });
+        }
+        REQUIRE(log == std::vector<std::string>{"second"});
+    }
+
+    SECTION("a replacement that fails to store keeps the previous action")
+    {
+        struct throwing_move
+        {
+            std::vector<std::string> * log;
+
+            explicit throwing_move(std::vector<std::string> * l)
+                : log{l}
+            {}
+            throwing_move(throwing_move &&) { throw std::runtime_error("move"); }
+
+            void operator()() const { log->push_back("replacement"); }
+        };
+
+        {
+            cleanup_registry<coalesce::last_wins> cleanups;
+            cleanups.defer(7, [&] { log.push_back("first"); });
+            REQUIRE_THROWS_AS(cleanups.defer(7, throwing_move{&log}), std::runtime_error);
+            REQUIRE(cleanups.size() == 1);
+        }
+        REQUIRE(log == std::vector<std::string>{"first"});
+    }
+}
+
+TEST_CASE("cleanup_registry storage", "[cleanup_registry][storage]")
+{
+    SECTION("many keys spill past the inline capacity")
+    {
+        int sum = 0;
+        {
+            cleanup_registry<coalesce::first_wins, 4> cleanups;
+            for (int round = 0; round != 3; ++round)
+            {
+                for (int k = 1; k <= 100; ++k)
+                {
+                    cleanups.defer(k, [&sum, k] { sum += k; });
+                }
+            }
+            REQUIRE(cleanups.size() == 100);
+        }
+        REQUIRE(sum == 5050);
+    }
+
+    SECTION("large callables")
+    {
+        std::array<int, 16> big{};
+        big[15] = 5;
+        int result = 0;
+        {
+            cleanup_registry<coalesce::last_wins> cleanups;
+            cleanups.defer(1, [big, &result] { result += big[15]; });
+            cleanups.defer(1, [big, &result] { result += 2 * big[15]; });
+        }
+        REQUIRE(result == 10);
+    }
+
+    SECTION("reset drops pending actions")
+    {
+        int runs = 0;
+        {
+            cleanup_registry<> cleanups;
+            cleanups.defer(1, [&] { ++runs; });
+            cleanups.reset();
+            REQUIRE(cleanups.size() == 0);
+            cleanups.defer(1, [&] { ++runs; });
+        }
+        REQUIRE(runs == 1);
+    }
+
+    SECTION("explicit run empties the registry")
+    {
+        int runs = 0;
+        {
+            cleanup_registry<> cleanups;
+            cleanups.defer(1, [&] { ++runs; });
+            cleanups.run();
+            REQUIRE(runs == 1);
+            REQUIRE_FALSE(cleanups.contains(1));
+        }
+        REQUIRE(runs == 1);
+    }
+}
+
+TEST_CASE("cleanup_registry with exceptions", "[cleanup_registry][exceptions]")
+{
+    SECTION("actions run during unwinding")
+    {
+        int runs = 0;
+        try
+        {
+            cleanup_registry<> cleanups;
+            cleanups.defer(1, [&] { ++runs; });
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(runs == 1);
+    }
+
+    SECTION("throwing action propagates and discards the rest")
+    {
+        int runs = 0;
+        auto body = [&] {
+            cleanup_registry<> cleanups;
+            cleanups.defer(1, [&] { ++runs; });
+            cleanups.defer(2, [] { throw std::runtime_error("cleanup"); });
+        };
+        REQUIRE_THROWS_AS(body(), std::runtime_error);
+        REQUIRE(runs == 0);
+    }
+}
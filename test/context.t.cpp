@@ -0,0 +1,166 @@
+#include <scope_exit/context.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using scope_exit_v1::capture_context;
+using scope_exit_v1::context_depth;
+using scope_exit_v1::context_guard;
+using scope_exit_v1::current_context;
+
+namespace
+{
+
+struct request_id
+{
+    unsigned long value;
+};
+
+struct tenant
+{
+    std::string name;
+};
+
+struct deadline
+{
+    std::chrono::steady_clock::time_point at;
+};
+
+struct small
+{
+    int value;
+};
+
+}  // namespace
+
+template <>
+constexpr std::size_t scope_exit_v1::context_capacity<small> = 2;
+
+TEST_CASE("context guards push and pop", "[context][basic]")
+{
+    REQUIRE(current_context<request_id>() == nullptr);
+
+    SECTION("innermost value is current")
+    {
+        {
+            scope(context, request_id, 1ul);
+            REQUIRE(current_context<request_id>()->value == 1);
+            {
+                scope(context, request_id, 2ul);
+                REQUIRE(current_context<request_id>()->value == 2);
+                REQUIRE(context_depth<request_id>() == 2);
+            }
+            REQUIRE(current_context<request_id>()->value == 1);
+        }
+        REQUIRE(current_context<request_id>() == nullptr);
+        REQUIRE(context_depth<request_id>() == 0);
+    }
+
+    SECTION("each type has its own stack")
+    {
+        scope(context, request_id, 7ul);
+        scope(context, tenant, "acme");
+        REQUIRE(current_context<request_id>()->value == 7);
+        REQUIRE(current_context<tenant>()->name == "acme");
+        REQUIRE(current_context<deadline>() == nullptr);
+    }
+
+    SECTION("values are popped during unwinding")
+    {
+        REQUIRE_THROWS_AS(
+            [] {
+                context_guard<tenant> t{"acme"};
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(current_context<tenant>() == nullptr);
+    }
+
+    SECTION("stacks are per thread")
+    {
+        scope(context, request_id, 3ul);
+        request_id const * seen = current_context<request_id>();
+        std::thread{[&] { seen = current_context<request_id>(); }}.join();
+        REQUIRE(seen == nullptr);
+    }
+}
+
+TEST_CASE("context stack capacity", "[context][capacity]")
+{
+    context_guard<small> a{1};
+    context_guard<small> b{2};
+    REQUIRE_THROWS_AS(context_guard<small>{3}, std::length_error);
+    REQUIRE(context_depth<small>() == 2);
+    REQUIRE(current_context<small>()->value == 2);
+}
+
+TEST_CASE("context capture and restore", "[context][capture]")
+{
+    SECTION("captured values are restored on another thread")
+    {
+        auto at = std::chrono::steady_clock::now();
+        scope(context, request_id, 42ul);
+        scope(context, tenant, "acme");
+        scope(context, deadline, at);
+
+        auto ctx = capture_context<request_id, tenant, deadline>();
+        REQUIRE(ctx.get<tenant>()->name == "acme");
+
+        bool ok = false;
+        std::thread{[&] {
+            ok = current_context<request_id>() == nullptr;
+            {
+                auto restored = ctx.restore();
+                ok = ok && current_context<request_id>()->value == 42 && current_context<tenant>()->name == "acme" &&
+                     current_context<deadline>()->at == at;
+            }
+            ok = ok && current_context<request_id>() == nullptr && current_context<tenant>() == nullptr;
+        }}.join();
+        REQUIRE(ok);
+    }
+
+    SECTION("absent values are not pushed")
+    {
+        scope(context, request_id, 5ul);
+        auto ctx = capture_context<request_id, tenant>();
+        REQUIRE(ctx.get<tenant>() == nullptr);
+
+        std::size_t ids = 0;
+        std::size_t tenants = 0;
+        std::thread{[&] {
+            auto restored = ctx.restore();
+            ids = context_depth<request_id>();
+            tenants = context_depth<tenant>();
+        }}.join();
+        REQUIRE(ids == 1);
+        REQUIRE(tenants == 0);
+    }
+
+    SECTION("capture outlives the captured scope")
+    {
+        auto ctx = [] {
+            scope(context, tenant, "scoped");
+            return capture_context<tenant>();
+        }();
+        REQUIRE(current_context<tenant>() == nullptr);
+
+        auto restored = ctx.restore();
+        REQUIRE(current_context<tenant>()->name == "scoped");
+    }
+
+    SECTION("a failed restore pops what it pushed")
+    {
+        scope(context, request_id, 9ul);
+        scope(context, small, 1);
+        auto ctx = capture_context<request_id, small>();
+
+        scope(context, small, 2);
+        REQUIRE_THROWS_AS(ctx.restore(), std::length_error);
+        REQUIRE(context_depth<request_id>() == 1);
+        REQUIRE(context_depth<small>() == 2);
+    }
+}
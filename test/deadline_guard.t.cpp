@@ -0,0 +1,211 @@
+#include <scope_exit/deadline_guard.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using scope_exit_v1::timer_wheel;
+
+namespace
+{
+
+struct recorder
+{
+    explicit recorder(std::vector<int> & log, int id)
+        : log_{&log}
+        , id_{id}
+    {
+        t.fire = [](void * self) {
+            auto * r = static_cast<recorder *>(self);
+            r->log_->push_back(r->id_);
+        };
+        t.context = this;
+    }
+
+    timer_wheel::timer t;
+    std::vector<int> * log_;
+    int id_;
+};
+
+}  // namespace
+
+TEST_CASE("timer_wheel fires expired timers", "[timer_wheel][basic]")
+{
+    auto const start = timer_wheel::clock::now();
+    timer_wheel wheel{1ms, start};
+    std::vector<int> log;
+
+    SECTION("fires in deadline order")
+    {
+        recorder a{log, 1}, b{log, 2}, c{log, 3};
+        wheel.arm(c.t, start + 30ms);
+        wheel.arm(a.t, start + 10ms);
+        wheel.arm(b.t, start + 20ms);
+        REQUIRE(wheel.size() == 3);
+
+        REQUIRE(wheel.advance(start + 9ms) == 0);
+        REQUIRE(wheel.advance(start + 10ms) == 1);
+        REQUIRE(wheel.advance(start + 40ms) == 2);
+        REQUIRE(log == std::vector<int>{1, 2, 3});
+        REQUIRE(wheel.size() == 0);
+        REQUIRE_FALSE(a.t.armed());
+    }
+
+    SECTION("deadline in the past fires on next advance")
+    {
+        recorder a{log, 1};
+        wheel.advance(start + 5ms);
+        wheel.arm(a.t, start);
+        REQUIRE(wheel.advance(start + 6ms) == 1);
+    }
+
+    SECTION("timers cascade down from upper levels")
+    {
+        std::vector<recorder> timers;
+        timers.reserve(5);
+        auto const deadlines = {63ms, 64ms, 4095ms, 4097ms, 300000ms};
+        int id = 0;
+        for (auto d : deadlines)
+        {
+            timers.emplace_back(log, id++);
+            wheel.arm(timers.back().t, start + d);
+        }
+
+        int expected = 0;
+        for (auto d : deadlines)
+        {
+            REQUIRE(wheel.advance(start + d - 1ms) == 0);
+            REQUIRE(wheel.advance(start + d) == 1);
+            REQUIRE(log.back() == expected++);
+        }
+    }
+
+    SECTION("timers beyond the wheel span go through overflow")
+    {
+        recorder a{log, 1};
+        auto const far = std::chrono::milliseconds{(1 << 24) + 100};
+        wheel.arm(a.t, start + far);
+        REQUIRE(wheel.advance(start + far - 1ms) == 0);
+        REQUIRE(wheel.advance(start + far) == 1);
+    }
+
+    SECTION("timers fire on time across long idle gaps")
+    {
+        // deadlines spread over several overflow rotations, advanced in irregular steps of up to ~70 minutes
+        std::vector<recorder> timers;
+        std::vector<std::chrono::milliseconds> deadlines;
+        timers.reserve(300);
+        std::uint64_t seed = 42;
+        auto next_random = [&seed] {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            return seed >> 33;
+        };
+        for (int id = 0; id != 300; ++id)
+        {
+            deadlines.emplace_back(next_random() % (std::uint64_t{1} << 27));
+            timers.emplace_back(log, id);
+            wheel.arm(timers.back().t, start + deadlines.back());
+            if (id % 7 == 0)
+            {
+                wheel.cancel(timers.back().t);
+            }
+        }
+
+        std::chrono::milliseconds previous{0};
+        for (std::chrono::milliseconds now{0}; wheel.size() != 0;)
+        {
+            now += std::chrono::milliseconds{1 + next_random() % (std::uint64_t{1} << 22)};
+            log.clear();
+            wheel.advance(start + now);
+            for (int id : log)
+            {
+                REQUIRE(id % 7 != 0);
+                REQUIRE(deadlines[id] > previous);
+                REQUIRE(deadlines[id] <= now);
+            }
+            previous = now;
+        }
+    }
+
+    SECTION("cancel unlinks in place")
+    {
+        recorder a{log, 1}, b{log, 2};
+        wheel.arm(a.t, start + 10ms);
+        wheel.arm(b.t, start + 10ms);
+        wheel.cancel(a.t);
+        wheel.cancel(a.t);
+        REQUIRE(wheel.size() == 1);
+        REQUIRE(wheel.advance(start + 10ms) == 1);
+        REQUIRE(log == std::vector<int>{2});
+    }
+}
+
+TEST_CASE("scope(deadline) guard", "[deadline_guard][basic]")
+{
+    auto & wheel = timer_wheel::local();
+
+    SECTION("fires when the scope outlives its deadline")
+    {
+        int fired = 0;
+        {
+            scope(deadline, 1ms) { ++fired; };
+            REQUIRE(wheel.size() == 1);
+            std::this_thread::sleep_for(5ms);
+            wheel.advance();
+            REQUIRE(fired == 1);
+            REQUIRE(wheel.size() == 0);
+        }
+        REQUIRE(fired == 1);
+    }
+
+    SECTION("cancelled when the scope exits in time")
+    {
+        int fired = 0;
+        {
+            scope(deadline, 50ms) { ++fired; };
+            wheel.advance();
+        }
+        REQUIRE(wheel.size() == 0);
+        std::this_thread::sleep_for(60ms);
+        wheel.advance();
+        REQUIRE(fired == 0);
+    }
+
+    SECTION("cancelled on exception")
+    {
+        int fired = 0;
+        try
+        {
+            scope(deadline, 50ms) { ++fired; };
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(wheel.size() == 0);
+        std::this_thread::sleep_for(60ms);
+        wheel.advance();
+        REQUIRE(fired == 0);
+    }
+
+    SECTION("nested deadlines fire independently")
+    {
+        std::vector<int> order;
+        {
+            scope(deadline, 20ms) { order.push_back(2); };
+            {
+                scope(deadline, 10ms) { order.push_back(1); };
+                std::this_thread::sleep_for(15ms);
+                wheel.advance();
+                REQUIRE(order == std::vector<int>{1});
+            }
+            std::this_thread::sleep_for(10ms);
+            wheel.advance();
+        }
+        REQUIRE(order == std::vector<int>{1, 2});
+    }
+}
@@ -0,0 +1,154 @@
+#include <scope_exit/inflight_tracker.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using scope_exit_v1::inflight_guard;
+using scope_exit_v1::inflight_tracker;
+
+TEST_CASE("inflight_tracker guards", "[inflight_tracker][basic]")
+{
+    inflight_tracker tracker{4};
+
+    SECTION("guards count requests while they live")
+    {
+        {
+            auto a = tracker.enter();
+            auto b = tracker.enter();
+            REQUIRE(a);
+            REQUIRE(b);
+            REQUIRE(tracker.in_flight() == 2);
+        }
+        REQUIRE(tracker.in_flight() == 0);
+    }
+
+    SECTION("a moved guard leaves once")
+    {
+        inflight_guard outer;
+        {
+            auto g = tracker.enter();
+            outer = std::move(g);
+            REQUIRE_FALSE(g);
+        }
+        REQUIRE(tracker.in_flight() == 1);
+        outer.release();
+        outer.release();
+        REQUIRE(tracker.in_flight() == 0);
+    }
+
+    SECTION("entering after a drain is rejected until reopened")
+    {
+        tracker.drain();
+        REQUIRE(tracker.draining());
+        auto rejected = tracker.enter();
+        REQUIRE_FALSE(rejected);
+        REQUIRE(tracker.in_flight() == 0);
+
+        tracker.reopen();
+        auto admitted = tracker.enter();
+        REQUIRE(admitted);
+    }
+
+    SECTION("drain_for gives up while requests are in flight")
+    {
+        auto g = tracker.enter();
+        REQUIRE_FALSE(tracker.drain_for(std::chrono::milliseconds{5}));
+        g.release();
+        REQUIRE(tracker.drain_for(std::chrono::milliseconds{5}));
+    }
+
+    SECTION("drain waits for a request that leaves on another thread")
+    {
+        auto g = tracker.enter();
+        std::thread leaver{[g = std::move(g)]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            g.release();
+        }};
+        tracker.drain();
+        REQUIRE(tracker.in_flight() == 0);
+        leaver.join();
+    }
+}
+
+TEST_CASE("inflight_tracker drain under thread churn", "[inflight_tracker][threads]")
+{
+    constexpr int generations = 20;
+    constexpr int threads_per_generation = 8;
+
+    SECTION("no admitted request is still running when drain returns")
+    {
+        inflight_tracker tracker{4};
+        std::atomic<int> running{0};
+        std::atomic<int> admitted{0};
+        std::atomic<bool> stop{false};
+
+        std::thread spawner{[&] {
+            // short-lived threads keep joining the shards while the drain is in progress
+            for (int gen = 0; gen != generations && !stop.load(); ++gen)
+            {
+                std::vector<std::thread> threads;
+                for (int t = 0; t != threads_per_generation; ++t)
+                {
+                    threads.emplace_back([&] {
+                        for (int i = 0; i != 500; ++i)
+                        {
+                            auto g = tracker.enter();
+                            if (!g)
+                            {
+                                return;
+                            }
+                            ++admitted;
+                            ++running;
+                            std::this_thread::yield();
+                            --running;
+                        }
+                    });
+                }
+                for (auto & t : threads)
+                {
+                    t.join();
+                }
+            }
+        }};
+
+        while (admitted.load() < 1000)
+        {
+            std::this_thread::yield();
+        }
+        tracker.drain();
+        int const running_at_drain = running.load();
+        int const admitted_at_drain = admitted.load();
+
+        stop.store(true);
+        spawner.join();
+        REQUIRE(running_at_drain == 0);
+        REQUIRE(admitted.load() == admitted_at_drain);
+        REQUIRE(tracker.in_flight() == 0);
+    }
+
+    SECTION("the tracker can be destroyed as soon as drain returns")
+    {
+        for (int round = 0; round != 100; ++round)
+        {
+            auto tracker = std::make_unique<inflight_tracker>(4u);
+            std::vector<std::thread> threads;
+            for (int t = 0; t != 4; ++t)
+            {
+                threads.emplace_back([g = tracker->enter()]() mutable { g.release(); });
+            }
+            tracker->drain();
+            tracker.reset();
+            for (auto & t : threads)
+            {
+                t.join();
+            }
+        }
+        SUCCEED();
+    }
+}
@@ -0,0 +1,158 @@
+#define SCOPE_EXIT_INSTRUMENT
+#include <scope_exit/scope_exit.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::instrument;
+using scope_exit_v1::site_stats;
+
+namespace
+{
+
+site_stats const * find_site(std::vector<site_stats> const & sites, int line)
+{
+    for (auto const & s : sites)
+    {
+        if (s.line == line && std::strstr(s.file, "instrument.t.cpp") != nullptr)
+        {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+int exit_line = 0;
+int failure_line = 0;
+
+void guarded(bool fail)
+{
+    int cleanups = 0;
+    exit_line = __LINE__ + 1;
+    scope(exit) { ++cleanups; };
+    failure_line = __LINE__ + 1;
+    scope(failure) { ++cleanups; };
+    if (fail)
+    {
+        throw std::runtime_error{"boom"};
+    }
+}
+
+}  // namespace
+
+TEST_CASE("instrumented guards record per-site statistics", "[instrument][basic]")
+{
+    instrument::reset();
+    guarded(false);
+    guarded(false);
+    REQUIRE_THROWS_AS(guarded(true), std::runtime_error);
+
+    auto sites = instrument::sites();
+    auto const * exit_site = find_site(sites, exit_line);
+    auto const * failure_site = find_site(sites, failure_line);
+    REQUIRE(exit_site != nullptr);
+    REQUIRE(failure_site != nullptr);
+
+    CHECK(std::string{exit_site->kind} == "exit");
+    CHECK(std::string{failure_site->kind} == "failure");
+    CHECK(exit_site->id != failure_site->id);
+    CHECK(exit_site->entries == 3);
+    CHECK(failure_site->entries == 3);
+    CHECK(exit_site->active == 0);
+    CHECK(exit_site->peak == 1);
+}
+
+TEST_CASE("instrumented guards track concurrency", "[instrument][threads]")
+{
+    constexpr int threads = 6;
+    instrument::set_sample_period(1);
+
+    std::atomic<int> line{0};
+    std::atomic<int> arrived{0};
+    std::atomic<bool> release{false};
+    auto body = [&] {
+        line = __LINE__ + 1;
+        scope(exit) { };
+        ++arrived;
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t != threads; ++t)
+    {
+        pool.emplace_back(body);
+    }
+    while (arrived.load() != threads)
+    {
+        std::this_thread::yield();
+    }
+
+    auto const during = instrument::sites();
+    release.store(true);
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+
+    SECTION("every thread inside the region is counted")
+    {
+        auto const * site = find_site(during, line);
+        REQUIRE(site != nullptr);
+        CHECK(site->active == threads);
+        CHECK(site->peak == threads);
+
+        auto const sites = instrument::sites();
+        auto const * after = find_site(sites, line);
+        REQUIRE(after != nullptr);
+        CHECK(after->active == 0);
+        CHECK(after->peak == threads);
+    }
+
+    SECTION("sampling still counts every entry")
+    {
+        instrument::reset();
+        instrument::set_sample_period(16);
+        for (int i = 0; i != 100; ++i)
+        {
+            body();
+        }
+        instrument::set_sample_period(1);
+
+        auto const sites = instrument::sites();
+        auto const * site = find_site(sites, line);
+        REQUIRE(site != nullptr);
+        CHECK(site->entries == 100);
+        CHECK(site->peak <= 1);
+    }
+}
+
+TEST_CASE("instrument report lists sites", "[instrument][report]")
+{
+    guarded(false);
+
+    std::FILE * out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    instrument::report(out);
+    std::rewind(out);
+
+    std::string text;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof buffer, out) != nullptr)
+    {
+        text += buffer;
+    }
+    std::fclose(out);
+
+    CHECK(text.find("peak") != std::string::npos);
+    CHECK(text.find("instrument.t.cpp:" + std::to_string(exit_line)) != std::string::npos);
+}
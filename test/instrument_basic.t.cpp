@@ -0,0 +1,49 @@
+#define SCOPE_EXIT_INSTRUMENT
+#include <scope_exit/scope_exit.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+
+// Linked with instrument_depth.t.cpp: instrumented translation units with and without SCOPE_EXIT_INSTRUMENT_DEPTH in
+// one program.
+
+using scope_exit_v1::instrument;
+
+void guarded_with_depth();
+bool depth_registry_has(char const * file);
+
+namespace
+{
+
+int basic_line = 0;
+
+void guarded_basic()
+{
+    basic_line = __LINE__ + 1;
+    scope(exit) { };
+}
+
+}  // namespace
+
+TEST_CASE("translation units with and without depth tracking keep separate registries", "[instrument_depth][odr]")
+{
+    instrument::reset();
+    guarded_basic();
+    guarded_with_depth();
+
+    bool found = false;
+    for (auto const & s : instrument::sites())
+    {
+        REQUIRE(std::strstr(s.file, "instrument_depth.t.cpp") == nullptr);
+        if (s.line == basic_line && std::strstr(s.file, "instrument_basic.t.cpp") != nullptr)
+        {
+            found = true;
+            CHECK(s.entries == 1);
+            CHECK(s.max_depth == 0);
+        }
+    }
+    REQUIRE(found);
+    REQUIRE(depth_registry_has("instrument_depth.t.cpp"));
+    REQUIRE_FALSE(depth_registry_has("instrument_basic.t.cpp"));
+}
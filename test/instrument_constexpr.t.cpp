@@ -0,0 +1,55 @@
+#define SCOPE_EXIT_INSTRUMENT
+#include <scope_exit/scope_exit.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+// Built as C++20 or later (see CMakeLists.txt): instrumented guards must stay usable in constant expressions.
+
+using scope_exit_v1::instrument;
+
+namespace
+{
+
+constexpr int exit_line = __LINE__ + 6;
+
+constexpr int guarded_sum()
+{
+    int sum = 0;
+    {
+        scope(exit) { sum += 1; };
+        scope(success) { sum += 10; };
+        scope(failure) { sum += 100; };
+    }
+    return sum;
+}
+
+std::uint64_t exit_entries()
+{
+    for (auto const & s : instrument::sites())
+    {
+        if (s.line == exit_line && std::strstr(s.file, "instrument_constexpr.t.cpp") != nullptr)
+        {
+            return s.entries;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+TEST_CASE("instrumented guards in constant expressions", "[instrument][constexpr]")
+{
+    STATIC_REQUIRE(guarded_sum() == 11);
+
+    // only runtime calls reach the probes
+    instrument::reset();
+    int volatile calls = 2;
+    for (int i = 0; i != calls; ++i)
+    {
+        REQUIRE(guarded_sum() == 11);
+    }
+    REQUIRE(exit_entries() == 2);
+}
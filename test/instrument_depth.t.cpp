@@ -0,0 +1,187 @@
+#define SCOPE_EXIT_INSTRUMENT_DEPTH
+#include <scope_exit/scope_exit.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::instrument;
+using scope_exit_v1::site_stats;
+
+namespace
+{
+
+site_stats const * find_site(std::vector<site_stats> const & sites, int line)
+{
+    for (auto const & s : sites)
+    {
+        if (s.line == line && std::strstr(s.file, "instrument_depth.t.cpp") != nullptr)
+        {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+std::atomic<int> recurse_line{0};
+int outer_line = 0;
+int inner_line = 0;
+
+int recurse(int depth, int throw_at)
+{
+    volatile char frame[64] = {};  // give every level a frame of its own
+    recurse_line = __LINE__ + 1;
+    scope(exit) { frame[0] = 0; };
+    if (depth == throw_at)
+    {
+        throw std::runtime_error{"too deep"};
+    }
+    return depth <= 1 ? frame[0] : recurse(depth - 1, throw_at) + frame[1];
+}
+
+void inner()
+{
+    inner_line = __LINE__ + 1;
+    scope(exit) { };
+}
+
+void outer()
+{
+    outer_line = __LINE__ + 1;
+    scope(exit) { };
+    inner();
+}
+
+}  // namespace
+
+// used by instrument_basic.t.cpp, which is compiled without SCOPE_EXIT_INSTRUMENT_DEPTH
+void guarded_with_depth()
+{
+    scope(exit) { };
+}
+
+bool depth_registry_has(char const * file)
+{
+    for (auto const & s : instrument::sites())
+    {
+        if (std::strstr(s.file, file) != nullptr)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("instrumented guards record nesting depth", "[instrument_depth][basic]")
+{
+    instrument::reset();
+
+    SECTION("recursion fills the depth histogram")
+    {
+        recurse(10, -1);
+
+        auto const sites = instrument::sites();
+        auto const * site = find_site(sites, recurse_line);
+        REQUIRE(site != nullptr);
+        CHECK(site->entries == 10);
+        CHECK(site->max_depth == 10);
+        CHECK(site->depth[0] == 1);  // depth 1
+        CHECK(site->depth[1] == 2);  // depths 2-3
+        CHECK(site->depth[2] == 4);  // depths 4-7
+        CHECK(site->depth[3] == 3);  // depths 8-10
+        CHECK(site->max_stack >= 9 * 64);
+    }
+
+    SECTION("depth counts guards of every site on the thread")
+    {
+        outer();
+        inner();
+
+        auto const sites = instrument::sites();
+        auto const * o = find_site(sites, outer_line);
+        auto const * i = find_site(sites, inner_line);
+        REQUIRE(o != nullptr);
+        REQUIRE(i != nullptr);
+        CHECK(o->max_depth == 1);
+        CHECK(o->max_stack == 0);
+        CHECK(i->max_depth == 2);
+        CHECK(i->depth[0] == 1);
+        CHECK(i->depth[1] == 1);
+    }
+
+    SECTION("unwinding restores the depth")
+    {
+        REQUIRE_THROWS_AS(recurse(8, 4), std::runtime_error);
+        instrument::reset();
+        recurse(3, -1);
+
+        auto const sites = instrument::sites();
+        auto const * site = find_site(sites, recurse_line);
+        REQUIRE(site != nullptr);
+        CHECK(site->max_depth == 3);
+        CHECK(site->depth[0] == 1);
+    }
+
+    SECTION("reset zeroes the depth statistics")
+    {
+        recurse(5, -1);
+        instrument::reset();
+
+        auto const sites = instrument::sites();
+        auto const * site = find_site(sites, recurse_line);
+        REQUIRE(site != nullptr);
+        CHECK(site->max_depth == 0);
+        CHECK(site->max_stack == 0);
+        CHECK(site->depth[0] == 0);
+    }
+}
+
+TEST_CASE("nesting depth is per thread", "[instrument_depth][threads]")
+{
+    constexpr int threads = 4;
+    instrument::reset();
+
+    std::atomic<int> arrived{0};
+    std::atomic<bool> release{false};
+    std::atomic<int> line{0};
+    auto body = [&] {
+        line = __LINE__ + 1;
+        scope(exit) { };
+        ++arrived;
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+        recurse(3, -1);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t != threads; ++t)
+    {
+        pool.emplace_back(body);
+    }
+    while (arrived.load() != threads)
+    {
+        std::this_thread::yield();
+    }
+    release.store(true);
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+
+    auto const sites = instrument::sites();
+    auto const * outermost = find_site(sites, line);
+    auto const * nested = find_site(sites, recurse_line);
+    REQUIRE(outermost != nullptr);
+    REQUIRE(nested != nullptr);
+    CHECK(outermost->max_depth == 1);
+    CHECK(outermost->depth[0] == threads);
+    CHECK(nested->max_depth == 4);
+    CHECK(nested->entries == 3 * threads);
+}
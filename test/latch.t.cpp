@@ -0,0 +1,184 @@
+#include <scope_exit/latch.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::completion_latch;
+
+TEST_CASE("completion_latch counting", "[latch][basic]")
+{
+    SECTION("a latch with a zero count is ready")
+    {
+        completion_latch latch{0};
+        REQUIRE(latch.try_wait());
+        latch.wait();
+        latch.count_down();
+        latch.count_down(3);
+        REQUIRE(latch.try_wait());
+    }
+
+    SECTION("the latch opens after exactly count count-downs")
+    {
+        for (std::size_t count : {1u, 2u, 7u, 64u, 1000u})
+        {
+            completion_latch latch{count, 4};
+            for (std::size_t i = 0; i + 1 != count; ++i)
+            {
+                latch.count_down();
+            }
+            REQUIRE_FALSE(latch.try_wait());
+            latch.count_down();
+            REQUIRE(latch.try_wait());
+        }
+    }
+
+    SECTION("count_down(n) spans shards")
+    {
+        completion_latch latch{100, 8};
+        latch.count_down(60);
+        REQUIRE_FALSE(latch.try_wait());
+        latch.count_down(39);
+        REQUIRE_FALSE(latch.try_wait());
+        latch.count_down(1);
+        REQUIRE(latch.try_wait());
+    }
+
+    SECTION("wait_for times out while the count is not zero")
+    {
+        completion_latch latch{2};
+        latch.count_down();
+        REQUIRE_FALSE(latch.wait_for(std::chrono::milliseconds{5}));
+        latch.count_down();
+        REQUIRE(latch.wait_for(std::chrono::milliseconds{5}));
+    }
+}
+
+TEST_CASE("count_down guards", "[latch][guard]")
+{
+    completion_latch latch{3};
+
+    {
+        scope(count_down, latch);
+    }
+    REQUIRE_THROWS_AS(
+        [&] {
+            scope(count_down, latch);
+            throw std::runtime_error{"boom"};
+        }(),
+        std::runtime_error);
+    REQUIRE_FALSE(latch.try_wait());
+    REQUIRE(latch.failures() == 1);
+
+    try
+    {
+        throw std::runtime_error{"outer"};
+    }
+    catch (std::runtime_error const &)
+    {
+        // a guard created while an exception is being handled only counts its own scope
+        scope(count_down, latch);
+    }
+    REQUIRE(latch.try_wait());
+    REQUIRE(latch.failures() == 1);
+}
+
+TEST_CASE("completion_latch under contention", "[latch][threads]")
+{
+    constexpr int threads = 8;
+    constexpr int tasks_per_thread = 20'000;
+
+    SECTION("waiters wake once every task has counted down")
+    {
+        completion_latch latch{threads * tasks_per_thread, threads};
+        std::atomic<int> done{0};
+        std::atomic<int> early{0};
+
+        std::vector<std::thread> waiters;
+        for (int w = 0; w != 3; ++w)
+        {
+            waiters.emplace_back([&] {
+                latch.wait();
+                if (done.load() != threads * tasks_per_thread)
+                {
+                    ++early;
+                }
+            });
+        }
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t != threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i != tasks_per_thread; ++i)
+                {
+                    try
+                    {
+                        ++done;
+                        scope(count_down, latch);
+                        if ((t + i) % 100 == 0)
+                        {
+                            throw std::runtime_error{"task failed"};
+                        }
+                    }
+                    catch (std::runtime_error const &)
+                    {
+                    }
+                }
+            });
+        }
+
+        for (auto & w : workers)
+        {
+            w.join();
+        }
+        for (auto & w : waiters)
+        {
+            w.join();
+        }
+        REQUIRE(early.load() == 0);
+        REQUIRE(latch.failures() == threads * tasks_per_thread / 100);
+    }
+
+    SECTION("the waiter may destroy the latch as soon as it opens")
+    {
+        for (int round = 0; round != 200; ++round)
+        {
+            auto latch = std::make_unique<completion_latch>(threads, threads);
+            std::vector<std::thread> workers;
+            for (int t = 0; t != threads; ++t)
+            {
+                workers.emplace_back([l = latch.get()] { scope(count_down, *l); });
+            }
+            latch->wait();
+            latch.reset();
+            for (auto & w : workers)
+            {
+                w.join();
+            }
+        }
+
+        // count_down(n) finishing several shards, the last of them from a worker
+        for (int round = 0; round != 200; ++round)
+        {
+            auto latch = std::make_unique<completion_latch>(3 * threads, threads);
+            std::vector<std::thread> workers;
+            for (int t = 0; t != threads; ++t)
+            {
+                workers.emplace_back([l = latch.get()] { l->count_down(3); });
+            }
+            latch->wait();
+            latch.reset();
+            for (auto & w : workers)
+            {
+                w.join();
+            }
+        }
+        SUCCEED();
+    }
+}
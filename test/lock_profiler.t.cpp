@@ -0,0 +1,187 @@
+#include <scope_exit/lock_profiler.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::lock_profile;
+using scope_exit_v1::lock_stats;
+
+namespace
+{
+
+lock_stats find_site(int line)
+{
+    for (auto const & s : lock_profile::sites())
+    {
+        if (s.line == line)
+        {
+            return s;
+        }
+    }
+    return {};
+}
+
+// BasicLockable without try_lock: every acquisition is timed as a wait.
+class spin_lock
+{
+public:
+    void lock()
+    {
+        while (locked_.exchange(true, std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+}  // namespace
+
+TEST_CASE("uncontended profiled locks", "[lock_profiler][basic]")
+{
+    lock_profile::reset();
+    std::mutex m;
+    int line = 0;
+    int value = 0;
+    for (int i = 0; i != 100; ++i)
+    {
+        line = __LINE__ + 1;
+        scope(locked, m);
+        ++value;
+    }
+    REQUIRE(value == 100);
+
+    auto const s = find_site(line);
+    CHECK(s.acquisitions == 100);
+    CHECK(s.contended == 0);
+    CHECK(s.wait_ns == 0);
+    CHECK(m.try_lock());
+    m.unlock();
+
+    SECTION("the lock is released when the scope exits through an exception")
+    {
+        REQUIRE_THROWS_AS(
+            [&] {
+                scope(locked, m);
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        CHECK(m.try_lock());
+        m.unlock();
+    }
+
+    SECTION("mutexes without try_lock time every acquisition")
+    {
+        spin_lock spin;
+        int spin_line = 0;
+        for (int i = 0; i != 10; ++i)
+        {
+            spin_line = __LINE__ + 1;
+            scope(locked, spin);
+        }
+        auto const t = find_site(spin_line);
+        CHECK(t.acquisitions == 10);
+        CHECK(t.contended == 10);
+    }
+}
+
+TEST_CASE("contended profiled locks", "[lock_profiler][threads]")
+{
+    lock_profile::reset();
+    std::mutex m;
+    std::atomic<bool> holding{false};
+    std::atomic<int> holder_line{0};
+    std::atomic<int> waiter_line{0};
+
+    std::thread holder{[&] {
+        holder_line = __LINE__ + 1;
+        scope(locked, m);
+        holding = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{30});
+    }};
+    while (!holding.load())
+    {
+        std::this_thread::yield();
+    }
+    {
+        waiter_line = __LINE__ + 1;
+        scope(locked, m);
+    }
+    holder.join();
+
+    auto const held = find_site(holder_line);
+    auto const waited = find_site(waiter_line);
+
+    CHECK(held.acquisitions == 1);
+    CHECK(held.hold_ns >= 30'000'000u);
+    CHECK(lock_stats::quantile(held.hold, 0.99) >= 30'000'000u);
+
+    CHECK(waited.acquisitions == 1);
+    CHECK(waited.contended == 1);
+    CHECK(waited.wait_ns >= 10'000'000u);
+    CHECK(lock_stats::quantile(waited.wait, 0.5) >= waited.wait_ns);
+
+    SECTION("the report ranks the waiting site first")
+    {
+        std::FILE * out = std::tmpfile();
+        REQUIRE(out != nullptr);
+        lock_profile::report(out);
+        std::rewind(out);
+        std::string text;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof buffer, out) != nullptr)
+        {
+            text += buffer;
+        }
+        std::fclose(out);
+
+        auto waiter_at = text.find("lock_profiler.t.cpp:" + std::to_string(waiter_line.load()));
+        auto holder_at = text.find("lock_profiler.t.cpp:" + std::to_string(holder_line.load()));
+        REQUIRE(waiter_at != std::string::npos);
+        REQUIRE(holder_at != std::string::npos);
+        CHECK(waiter_at < holder_at);
+    }
+
+    SECTION("reset clears every site")
+    {
+        lock_profile::reset();
+        CHECK(find_site(waiter_line).acquisitions == 0);
+    }
+}
+
+TEST_CASE("profiled locks under contention keep mutual exclusion", "[lock_profiler][threads]")
+{
+    std::mutex m;
+    long counter = 0;
+    std::atomic<int> line{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i != 10'000; ++i)
+            {
+                line = __LINE__ + 1;
+                scope(locked, m);
+                ++counter;
+            }
+        });
+    }
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+    CHECK(counter == 40'000);
+    CHECK(find_site(line).acquisitions == 40'000);
+}
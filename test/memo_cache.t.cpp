@@ -0,0 +1,162 @@
+#include <scope_exit/memo_cache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <string>
+
+using scope_exit_v1::memo_scope;
+
+TEST_CASE("memo_scope caches computed values", "[memo_cache][basic]")
+{
+    int calls = 0;
+    auto square = [&](int k) {
+        ++calls;
+        return k * k;
+    };
+
+    SECTION("second lookup is a hit")
+    {
+        memo_scope<int, int> memo;
+        REQUIRE(memo.get_or_compute(7, square) == 49);
+        REQUIRE(memo.get_or_compute(7, square) == 49);
+        REQUIRE(calls == 1);
+        REQUIRE(memo.hits() == 1);
+        REQUIRE(memo.misses() == 1);
+        REQUIRE(memo.size() == 1);
+        REQUIRE(*memo.find(7) == 49);
+        REQUIRE(memo.find(8) == nullptr);
+    }
+
+    SECTION("table grows past its initial capacity")
+    {
+        memo_scope<int, int> memo{4};
+        for (int i = 0; i != 10000; ++i)
+        {
+            memo.get_or_compute(i, square);
+        }
+        for (int i = 0; i != 10000; ++i)
+        {
+            REQUIRE(memo.get_or_compute(i, square) == i * i);
+        }
+        REQUIRE(calls == 10000);
+        REQUIRE(memo.size() == 10000);
+    }
+
+    SECTION("memoize without a scope just computes")
+    {
+        REQUIRE(memo_scope<int, int>::current() == nullptr);
+        scope_exit_v1::memoize<int, int>(3, square);
+        scope_exit_v1::memoize<int, int>(3, square);
+        REQUIRE(calls == 2);
+    }
+
+    SECTION("memoize uses the current scope")
+    {
+        memo_scope<int, int> memo;
+        REQUIRE(memo_scope<int, int>::current() == &memo);
+        scope_exit_v1::memoize<int, int>(3, square);
+        scope_exit_v1::memoize<int, int>(3, square);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("failed computation caches nothing")
+    {
+        memo_scope<int, int> memo;
+        REQUIRE_THROWS_AS(memo.get_or_compute(1, [](int) -> int { throw std::runtime_error("error"); }),
+                          std::runtime_error);
+        REQUIRE(memo.size() == 0);
+        REQUIRE(memo.get_or_compute(1, square) == 1);
+    }
+}
+
+TEST_CASE("nested memo scopes", "[memo_cache][nested]")
+{
+    int calls = 0;
+    auto twice = [&](int k) {
+        ++calls;
+        return 2 * k;
+    };
+
+    memo_scope<int, int> outer;
+    outer.get_or_compute(1, twice);
+
+    {
+        memo_scope<int, int> inner;
+        REQUIRE(inner.parent() == &outer);
+        REQUIRE(memo_scope<int, int>::current() == &inner);
+
+        // inner scopes see outer entries
+        REQUIRE(inner.get_or_compute(1, twice) == 2);
+        REQUIRE(calls == 1);
+        REQUIRE(inner.hits() == 1);
+
+        // new entries go to the inner scope
+        inner.get_or_compute(2, twice);
+        REQUIRE(inner.size() == 1);
+        REQUIRE(outer.size() == 1);
+        REQUIRE(outer.find(2) == nullptr);
+    }
+
+    // inner entries are gone with the inner scope
+    REQUIRE(memo_scope<int, int>::current() == &outer);
+    REQUIRE(outer.find(2) == nullptr);
+    outer.get_or_compute(2, twice);
+    REQUIRE(calls == 3);
+}
+
+TEST_CASE("enclosing memo scopes refuse to insert", "[memo_cache][nested]")
+{
+    int calls = 0;
+    auto twice = [&](int k) {
+        ++calls;
+        return 2 * k;
+    };
+
+    memo_scope<int, int> outer(4);
+    outer.insert(1, 2);
+
+    {
+        memo_scope<int, int> inner;
+        inner.insert(100, 200);
+
+        // enough inserts to grow the outer table if they were allowed
+        for (int k = 2; k != 64; ++k)
+        {
+            REQUIRE_THROWS_AS(outer.insert(k, 2 * k), std::logic_error);
+        }
+        REQUIRE_THROWS_AS(outer.get_or_compute(2, twice), std::logic_error);
+        REQUIRE(calls == 0);
+
+        // hits in the enclosing scope are still served
+        REQUIRE(outer.get_or_compute(1, twice) == 2);
+        REQUIRE(outer.insert(1, 5) == 2);
+        REQUIRE(outer.size() == 1);
+        REQUIRE(*inner.find(100) == 200);
+    }
+
+    // once the inner scope is gone the outer one may insert again
+    for (int k = 2; k != 64; ++k)
+    {
+        outer.insert(k, 2 * k);
+    }
+    REQUIRE(outer.size() == 63);
+    REQUIRE(*outer.find(1) == 2);
+    REQUIRE(*outer.find(63) == 126);
+}
+
+TEST_CASE("memo_scope with non-trivial types", "[memo_cache][types]")
+{
+    std::string const long_suffix(64, '!');
+    for (int round = 0; round != 3; ++round)
+    {
+        memo_scope<std::string, std::string> memo{2};
+        for (int i = 0; i != 100; ++i)
+        {
+            auto key = std::to_string(i);
+            REQUIRE(memo.get_or_compute(key, [&](std::string const & k) { return k + long_suffix; }) ==
+                    key + long_suffix);
+        }
+        REQUIRE(memo.size() == 100);
+    }
+}
@@ -0,0 +1,361 @@
+#include <scope_exit/mvcc_store.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using store_type = scope_exit_v1::mvcc_store<std::string, int>;
+
+TEST_CASE("mvcc_store write scopes", "[mvcc_store][basic]")
+{
+    store_type store;
+
+    SECTION("writes become visible when the scope succeeds")
+    {
+        {
+            store_type::write_scope tx{store};
+            tx.put("a", 1);
+            tx.put("b", 2);
+
+            store_type::read_scope before{store};
+            REQUIRE(before.find("a") == nullptr);
+        }
+        store_type::read_scope after{store};
+        REQUIRE(*after.find("a") == 1);
+        REQUIRE(*after.find("b") == 2);
+        REQUIRE(after.number() == 1);
+    }
+
+    SECTION("writes are dropped when the scope fails")
+    {
+        REQUIRE_THROWS_AS(
+            [&] {
+                store_type::write_scope tx{store};
+                tx.put("a", 1);
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        store_type::read_scope snapshot{store};
+        REQUIRE(snapshot.find("a") == nullptr);
+        REQUIRE(snapshot.number() == 0);
+    }
+
+    SECTION("a scope sees its own writes")
+    {
+        {
+            store_type::write_scope tx{store};
+            tx.put("a", 1);
+        }
+        store_type::write_scope tx{store};
+        REQUIRE(*tx.find("a") == 1);
+        tx.put("a", 5);
+        tx.put("a", 6);
+        REQUIRE(*tx.find("a") == 6);
+        REQUIRE(tx.size() == 1);
+        tx.erase("a");
+        REQUIRE_FALSE(tx.find("a").has_value());
+    }
+
+    SECTION("erase removes keys")
+    {
+        {
+            store_type::write_scope tx{store};
+            tx.put("a", 1);
+            tx.put("b", 2);
+        }
+        {
+            store_type::write_scope tx{store};
+            tx.erase("a");
+        }
+        store_type::read_scope snapshot{store};
+        REQUIRE(snapshot.find("a") == nullptr);
+        REQUIRE(*snapshot.find("b") == 2);
+    }
+
+    SECTION("an empty write scope does not create a version")
+    {
+        {
+            store_type::write_scope tx{store};
+        }
+        REQUIRE(store.version_number() == 0);
+    }
+}
+
+TEST_CASE("mvcc_store snapshots", "[mvcc_store][snapshot]")
+{
+    store_type store;
+    {
+        store_type::write_scope tx{store};
+        tx.put("k", 1);
+    }
+
+    SECTION("a read scope keeps its version while others commit")
+    {
+        store_type::read_scope old{store};
+        for (int i = 2; i != 100; ++i)
+        {
+            store_type::write_scope tx{store};
+            tx.put("k", i);
+            tx.put("other" + std::to_string(i), i);
+        }
+        REQUIRE(*old.find("k") == 1);
+        REQUIRE(old.find("other5") == nullptr);
+        REQUIRE(old.number() == 1);
+
+        store_type::read_scope now{store};
+        REQUIRE(*now.find("k") == 99);
+        REQUIRE(*now.find("other5") == 5);
+        REQUIRE(now.number() == 99);
+    }
+
+    SECTION("long delta chains are folded")
+    {
+        for (int i = 0; i != 3 * static_cast<int>(store_type::max_chain); ++i)
+        {
+            store_type::write_scope tx{store};
+            tx.put("key" + std::to_string(i % 7), i);
+        }
+        store_type::read_scope snapshot{store};
+        for (int j = 0; j != 7; ++j)
+        {
+            int last = 0;
+            for (int i = 0; i != 3 * static_cast<int>(store_type::max_chain); ++i)
+            {
+                if (i % 7 == j)
+                {
+                    last = i;
+                }
+            }
+            REQUIRE(*snapshot.find("key" + std::to_string(j)) == last);
+        }
+        REQUIRE(*snapshot.find("k") == 1);
+    }
+
+    SECTION("large write sets are published as a full version")
+    {
+        {
+            store_type::write_scope tx{store};
+            for (int i = 0; i != 2 * static_cast<int>(store_type::max_delta); ++i)
+            {
+                tx.put(std::to_string(i), i);
+            }
+            tx.erase("k");
+        }
+        store_type::read_scope snapshot{store};
+        REQUIRE(snapshot.find("k") == nullptr);
+        REQUIRE(*snapshot.find("17") == 17);
+        REQUIRE(snapshot.number() == 2);
+    }
+
+    SECTION("replaced versions are reclaimed after readers leave")
+    {
+        for (int i = 0; i != 10 * static_cast<int>(store_type::max_chain); ++i)
+        {
+            store_type::write_scope tx{store};
+            tx.put("k", i);
+        }
+        scope_exit_v1::detail::rcu::synchronize();
+        REQUIRE(scope_exit_v1::detail::rcu::pending() == 0);
+    }
+}
+
+TEST_CASE("mvcc_store concurrent readers and writers", "[mvcc_store][threads]")
+{
+    store_type store;
+    {
+        store_type::write_scope tx{store};
+        tx.put("a", 0);
+        tx.put("b", 0);
+    }
+
+    constexpr int writers = 2;
+    constexpr int readers = 2;
+    constexpr int commits = 2000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> backwards{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r != readers; ++r)
+    {
+        threads.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!done.load())
+            {
+                store_type::read_scope snapshot{store};
+                // every commit writes the same value to both keys
+                int const * a = snapshot.find("a");
+                int const * b = snapshot.find("b");
+                if (a == nullptr || b == nullptr || *a != *b)
+                {
+                    ++torn;
+                }
+                if (snapshot.number() < last)
+                {
+                    ++backwards;
+                }
+                last = snapshot.number();
+            }
+        });
+    }
+    for (int w = 0; w != writers; ++w)
+    {
+        threads.emplace_back([&, w] {
+            for (int i = 1; i <= commits; ++i)
+            {
+                try
+                {
+                    store_type::write_scope tx{store};
+                    tx.put("a", w * commits + i);
+                    tx.put("b", w * commits + i);
+                    if (i % 10 == 0)
+                    {
+                        throw std::runtime_error{"rollback"};
+                    }
+                }
+                catch (std::runtime_error const &)
+                {
+                }
+            }
+        });
+    }
+
+    for (int i = readers; i != readers + writers; ++i)
+    {
+        threads[i].join();
+    }
+    done.store(true);
+    for (int i = 0; i != readers; ++i)
+    {
+        threads[i].join();
+    }
+
+    REQUIRE(torn.load() == 0);
+    REQUIRE(backwards.load() == 0);
+    REQUIRE(store.version_number() == 1 + writers * (commits - commits / 10));
+}
+
+TEST_CASE("mvcc_store read-modify-write", "[mvcc_store][conflict]")
+{
+    store_type store;
+    {
+        store_type::write_scope tx{store};
+        tx.put("a", 10);
+        tx.put("b", 10);
+    }
+
+    SECTION("a write scope reads the version it opened on")
+    {
+        store_type::write_scope tx{store};
+        {
+            store_type::write_scope other{store};
+            other.put("a", 20);
+        }
+        REQUIRE(*tx.find("a") == 10);
+    }
+
+    SECTION("the first committer wins")
+    {
+        auto stale = [&] {
+            store_type::write_scope tx{store};
+            int a = *tx.find("a");
+            {
+                store_type::write_scope other{store};
+                other.put("a", 20);
+            }
+            tx.put("a", a + 1);
+            tx.put("b", 0);
+        };
+        REQUIRE_THROWS_AS(stale(), scope_exit_v1::mvcc_conflict);
+
+        store_type::read_scope snapshot{store};
+        REQUIRE(*snapshot.find("a") == 20);
+        REQUIRE(*snapshot.find("b") == 10);
+    }
+
+    SECTION("writes to keys the scope did not read do not conflict")
+    {
+        {
+            store_type::write_scope tx{store};
+            int a = *tx.find("a");
+            {
+                store_type::write_scope other{store};
+                other.put("b", 20);
+            }
+            tx.put("a", a + 1);
+            tx.put("b", 30);
+        }
+        store_type::read_scope snapshot{store};
+        REQUIRE(*snapshot.find("a") == 11);
+        REQUIRE(*snapshot.find("b") == 30);
+    }
+
+    SECTION("update reruns the transaction after a conflict")
+    {
+        int runs = 0;
+        store.update([&](store_type::write_scope & tx) {
+            int a = *tx.find("a");
+            if (++runs == 1)
+            {
+                store_type::write_scope other{store};
+                other.put("a", 20);
+            }
+            tx.put("a", a + 1);
+        });
+        REQUIRE(runs == 2);
+        store_type::read_scope snapshot{store};
+        REQUIRE(*snapshot.find("a") == 21);
+    }
+}
+
+TEST_CASE("mvcc_store concurrent transfers conserve the total", "[mvcc_store][conflict][threads]")
+{
+    constexpr int accounts = 4;
+    constexpr int threads = 4;
+    constexpr int transfers = 2000;
+
+    store_type store;
+    {
+        store_type::write_scope tx{store};
+        for (int i = 0; i != accounts; ++i)
+        {
+            tx.put(std::to_string(i), 1000);
+        }
+    }
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&store, t] {
+            for (int i = 0; i != transfers; ++i)
+            {
+                auto from = std::to_string((t + i) % accounts);
+                auto to = std::to_string((t + 2 * i + 1) % accounts);
+                store.update([&](store_type::write_scope & tx) {
+                    tx.put(from, *tx.find(from) - 1);
+                    tx.put(to, *tx.find(to) + 1);
+                });
+            }
+        });
+    }
+    for (auto & t : pool)
+    {
+        t.join();
+    }
+
+    store_type::read_scope snapshot{store};
+    int total = 0;
+    for (int i = 0; i != accounts; ++i)
+    {
+        int const * balance = snapshot.find(std::to_string(i));
+        REQUIRE(balance != nullptr);
+        total += *balance;
+    }
+    REQUIRE(total == accounts * 1000);
+    REQUIRE(snapshot.number() == 1 + threads * transfers);
+}
@@ -0,0 +1,306 @@
+#include <scope_exit/outbox.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::event_channel;
+using scope_exit_v1::outbox;
+
+namespace
+{
+
+struct event
+{
+    int id = 0;
+};
+
+template <typename Event>
+std::vector<Event> drain(event_channel<Event> & channel)
+{
+    std::vector<Event> events;
+    channel.drain([&](Event & e) { events.push_back(std::move(e)); });
+    return events;
+}
+
+std::vector<int> ids(std::vector<event> const & events)
+{
+    std::vector<int> result;
+    for (auto const & e : events)
+    {
+        result.push_back(e.id);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("outbox publishes on success only", "[outbox][basic]")
+{
+    event_channel<event> channel{64};
+
+    SECTION("events are published in emission order on success")
+    {
+        {
+            outbox<event> box{channel};
+            box.emit(event{1});
+            box.emit(event{2});
+            box.emit(event{3});
+            REQUIRE(box.size() == 3);
+            REQUIRE(channel.size() == 0);
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1, 2, 3});
+    }
+
+    SECTION("events are discarded on failure")
+    {
+        REQUIRE_THROWS_AS(
+            [&] {
+                outbox<event> box{channel};
+                box.emit(event{1});
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(channel.size() == 0);
+    }
+
+    SECTION("current() tracks the innermost outbox")
+    {
+        REQUIRE(outbox<event>::current() == nullptr);
+        outbox<event> box{channel};
+        REQUIRE(outbox<event>::current() == &box);
+        outbox<event>::current()->emit(event{7});
+        REQUIRE(box.size() == 1);
+    }
+
+    SECTION("non-trivial events are destroyed in both paths")
+    {
+        event_channel<std::string> strings{16};
+        {
+            outbox<std::string> box{strings};
+            box.emit(std::string(100, 'x'));
+        }
+        REQUIRE_THROWS_AS(
+            [&] {
+                outbox<std::string> box{strings};
+                box.emit(std::string(100, 'y'));
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(drain(strings) == std::vector<std::string>{std::string(100, 'x')});
+    }
+}
+
+TEST_CASE("nested outboxes merge into the parent", "[outbox][nested]")
+{
+    event_channel<event> channel{64};
+
+    SECTION("a successful inner outbox hands its events to the parent")
+    {
+        {
+            outbox<event> outer{channel};
+            outer.emit(event{1});
+            {
+                outbox<event> inner{channel};
+                inner.emit(event{2});
+                inner.emit(event{3});
+            }
+            REQUIRE(channel.size() == 0);
+            REQUIRE(outer.size() == 3);
+            outer.emit(event{4});
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1, 2, 3, 4});
+    }
+
+    SECTION("an enclosing outbox refuses to emit while an inner one is open")
+    {
+        {
+            outbox<event> outer{channel};
+            outer.emit(event{1});
+            {
+                outbox<event> inner{channel};
+                inner.emit(event{2});
+                REQUIRE_THROWS_AS(outer.emit(event{99}), std::logic_error);
+                REQUIRE(outer.size() == 1);
+                inner.emit(event{3});
+            }
+            outer.emit(event{4});
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1, 2, 3, 4});
+    }
+
+    SECTION("a failed inner outbox drops only its own events")
+    {
+        {
+            outbox<event> outer{channel};
+            outer.emit(event{1});
+            try
+            {
+                outbox<event> inner{channel};
+                inner.emit(event{2});
+                throw std::runtime_error{"boom"};
+            }
+            catch (std::runtime_error const &)
+            {
+            }
+            outer.emit(event{3});
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1, 3});
+    }
+
+    SECTION("merged events are dropped if the parent fails")
+    {
+        REQUIRE_THROWS_AS(
+            [&] {
+                outbox<event> outer{channel};
+                {
+                    outbox<event> inner{channel};
+                    inner.emit(event{1});
+                }
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(channel.size() == 0);
+    }
+
+    SECTION("an inner outbox for another channel publishes on its own")
+    {
+        event_channel<event> other{16};
+        {
+            outbox<event> outer{channel};
+            outer.emit(event{1});
+            {
+                outbox<event> inner{other};
+                inner.emit(event{2});
+            }
+            REQUIRE(ids(drain(other)) == std::vector<int>{2});
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1});
+    }
+
+    SECTION("deeply nested merges keep order")
+    {
+        {
+            outbox<event> a{channel};
+            a.emit(event{1});
+            {
+                outbox<event> b{channel};
+                b.emit(event{2});
+                {
+                    outbox<event> c{channel};
+                    c.emit(event{3});
+                }
+                b.emit(event{4});
+            }
+            {
+                outbox<event> d{channel};
+                d.emit(event{5});
+            }
+        }
+        REQUIRE(ids(drain(channel)) == std::vector<int>{1, 2, 3, 4, 5});
+    }
+}
+
+TEST_CASE("outbox batches larger than the channel", "[outbox][capacity]")
+{
+    event_channel<event> channel{8};
+    std::vector<int> received;
+    std::atomic<bool> done{false};
+
+    std::thread consumer{[&] {
+        while (!done.load() || channel.size() != 0)
+        {
+            channel.drain([&](event & e) { received.push_back(e.id); });
+            std::this_thread::yield();
+        }
+    }};
+
+    {
+        outbox<event> box{channel};
+        for (int i = 0; i != 100; ++i)
+        {
+            box.emit(event{i});
+        }
+    }
+    done.store(true);
+    consumer.join();
+
+    REQUIRE(received.size() == 100);
+    for (int i = 0; i != 100; ++i)
+    {
+        REQUIRE(received[i] == i);
+    }
+}
+
+TEST_CASE("outbox gives up on a stalled consumer", "[outbox][capacity]")
+{
+    using namespace std::chrono_literals;
+    event_channel<event> channel{4};
+    for (int i = 0; i != 4; ++i)
+    {
+        REQUIRE(channel.try_publish(event{i}));
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    {
+        outbox<event> box{channel, 20ms};
+        box.emit(event{10});
+        box.emit(event{11});
+    }
+    auto const waited = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(waited >= 20ms);
+    REQUIRE(waited < 5s);
+    REQUIRE(channel.dropped() == 2);
+    REQUIRE(ids(drain(channel)) == std::vector<int>{0, 1, 2, 3});
+}
+
+TEST_CASE("concurrent outboxes publish whole batches", "[outbox][threads]")
+{
+    event_channel<event> channel{1024};
+    constexpr int threads = 4;
+    constexpr int batches = 200;
+    constexpr int batch_size = 5;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t != threads; ++t)
+    {
+        producers.emplace_back([&, t] {
+            for (int b = 0; b != batches; ++b)
+            {
+                outbox<event> box{channel};
+                for (int i = 0; i != batch_size; ++i)
+                {
+                    box.emit(event{(t * batches + b) * batch_size + i});
+                }
+            }
+        });
+    }
+
+    std::vector<int> received;
+    while (received.size() != threads * batches * batch_size)
+    {
+        channel.drain([&](event & e) { received.push_back(e.id); });
+        std::this_thread::yield();
+    }
+    for (auto & p : producers)
+    {
+        p.join();
+    }
+
+    // each batch occupies consecutive positions in the channel
+    for (std::size_t i = 0; i != received.size(); i += batch_size)
+    {
+        REQUIRE(received[i] % batch_size == 0);
+        for (int j = 1; j != batch_size; ++j)
+        {
+            REQUIRE(received[i + j] == received[i] + j);
+        }
+    }
+}
@@ -0,0 +1,183 @@
+#include <scope_exit/parallel_region.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::parallel_budget;
+using scope_exit_v1::parallel_for;
+using scope_exit_v1::parallel_region_guard;
+using scope_exit_v1::thread_pool;
+
+namespace
+{
+
+// Tracks how many threads are inside a body at the same time.
+struct concurrency_meter
+{
+    void enter()
+    {
+        auto now = ++active;
+        auto seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now))
+        {
+        }
+    }
+
+    void leave() { --active; }
+
+    std::atomic<unsigned> active{0};
+    std::atomic<unsigned> peak{0};
+};
+
+void spin_for(std::chrono::microseconds d)
+{
+    auto until = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+}  // namespace
+
+TEST_CASE("parallel region guards", "[parallel_region][budget]")
+{
+    unsigned const outside = parallel_budget();
+    REQUIRE(outside == std::max(1u, std::thread::hardware_concurrency()));
+
+    SECTION("guards set the budget and restore it")
+    {
+        {
+            scope(parallel_region, 3);
+            REQUIRE(parallel_budget() == 3);
+            {
+                scope(parallel_region, 2);
+                REQUIRE(parallel_budget() == 2);
+            }
+            REQUIRE(parallel_budget() == 3);
+        }
+        REQUIRE(parallel_budget() == outside);
+    }
+
+    SECTION("a nested guard cannot widen the budget")
+    {
+        scope(parallel_region, 1);
+        scope(parallel_region, 64);
+        REQUIRE(parallel_budget() == 1);
+    }
+
+    SECTION("zero means one thread")
+    {
+        scope(parallel_region, 0);
+        REQUIRE(parallel_budget() == 1);
+    }
+
+    SECTION("the budget is restored on exception")
+    {
+        REQUIRE_THROWS_AS(
+            [] {
+                scope(parallel_region, 1);
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(parallel_budget() == outside);
+    }
+
+    SECTION("budgets are per thread")
+    {
+        scope(parallel_region, 1);
+        unsigned seen = 0;
+        std::thread{[&] { seen = parallel_budget(); }}.join();
+        REQUIRE(seen == outside);
+    }
+}
+
+TEST_CASE("parallel_for visits every index once", "[parallel_region][parallel_for]")
+{
+    thread_pool pool{3};
+    scope(parallel_region, 4);
+
+    for (std::size_t size : {0u, 1u, 7u, 100u, 10'000u})
+    {
+        for (std::size_t grain : {0u, 1u, 16u})
+        {
+            std::unique_ptr<std::atomic<int>[]> hits{new std::atomic<int>[size + 1]()};
+            parallel_for(pool, 5, 5 + size, [&](std::size_t i) { ++hits[i - 5]; }, grain);
+
+            bool once = true;
+            for (std::size_t i = 0; i != size; ++i)
+            {
+                once = once && hits[i].load() == 1;
+            }
+            REQUIRE(once);
+        }
+    }
+}
+
+TEST_CASE("parallel_for respects the budget", "[parallel_region][parallel_for]")
+{
+    thread_pool pool{7};
+
+    SECTION("no more threads than the budget run the body")
+    {
+        concurrency_meter meter;
+        {
+            parallel_region_guard region{3};
+            parallel_for(pool, 0, 64, [&](std::size_t) {
+                meter.enter();
+                spin_for(std::chrono::microseconds{200});
+                meter.leave();
+            }, 1);
+        }
+        REQUIRE(meter.peak.load() <= 3);
+    }
+
+    SECTION("nested loops share the budget instead of multiplying it")
+    {
+        concurrency_meter meter;
+        std::atomic<unsigned> inner_budget{0};
+        {
+            parallel_region_guard region{4};
+            parallel_for(pool, 0, 8, [&](std::size_t) {
+                inner_budget.store(parallel_budget());
+                parallel_for(pool, 0, 16, [&](std::size_t) {
+                    meter.enter();
+                    spin_for(std::chrono::microseconds{50});
+                    meter.leave();
+                }, 1);
+            }, 1);
+        }
+        REQUIRE(meter.peak.load() <= 4);
+        REQUIRE(inner_budget.load() == 1);
+    }
+
+    SECTION("a budget of one runs on the caller")
+    {
+        parallel_region_guard region{1};
+        auto caller = std::this_thread::get_id();
+        bool elsewhere = false;
+        parallel_for(pool, 0, 100, [&](std::size_t) { elsewhere = elsewhere || std::this_thread::get_id() != caller; });
+        REQUIRE_FALSE(elsewhere);
+    }
+
+    SECTION("the first exception is rethrown to the caller")
+    {
+        parallel_region_guard region{4};
+        std::atomic<int> calls{0};
+        auto body = [&](std::size_t i) {
+            ++calls;
+            if (i == 3)
+            {
+                throw std::runtime_error{"boom"};
+            }
+        };
+        REQUIRE_THROWS_AS(parallel_for(pool, 0, 10'000, body, 1), std::runtime_error);
+        REQUIRE(calls.load() < 10'000);
+    }
+}
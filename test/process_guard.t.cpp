@@ -0,0 +1,186 @@
+#include <scope_exit/process_guard.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cerrno>
+#include <csignal>
+#include <stdexcept>
+#include <set>
+
+#include <sys/wait.h>
+
+namespace
+{
+
+bool is_reaped(pid_t pid)
+{
+    // once reaped, the pid is no longer our child
+    return ::waitpid(pid, nullptr, WNOHANG) == -1 && errno == ECHILD;
+}
+
+}  // namespace
+
+TEST_CASE("process_guard waits for child on success", "[process_guard][basic]")
+{
+    SECTION("exit status of /bin/true")
+    {
+        pid_t pid = 0;
+        {
+            auto child = scope_exit_v1::process_guard::spawn({"/bin/true"});
+            pid = child.pid();
+            REQUIRE(child.pidfd() >= 0);
+        }
+
+        REQUIRE(is_reaped(pid));
+    }
+
+    SECTION("explicit wait returns exit code")
+    {
+        auto child = scope_exit_v1::process_guard::spawn({"/bin/false"});
+        REQUIRE(child.wait() == 1);
+        REQUIRE(child.wait() == 1);
+        REQUIRE(child.pidfd() == -1);
+    }
+
+    SECTION("successful scope does not kill the child")
+    {
+        auto child = scope_exit_v1::process_guard::spawn({"/bin/sleep", "0.1"});
+        int status = -1;
+        REQUIRE_FALSE(child.try_wait(status));
+        REQUIRE(child.wait() == 0);
+        REQUIRE(child.try_wait(status));
+        REQUIRE(status == 0);
+    }
+}
+
+TEST_CASE("process_guard kills child on failure", "[process_guard][failure]")
+{
+    pid_t pid = 0;
+
+    try
+    {
+        auto child = scope_exit_v1::process_guard::spawn({"/bin/sleep", "60"});
+        pid = child.pid();
+        throw std::runtime_error("fail");
+    }
+    catch (std::runtime_error const &)
+    {
+    }
+
+    REQUIRE(pid > 0);
+    REQUIRE(is_reaped(pid));
+}
+
+TEST_CASE("process_guard explicit kill", "[process_guard][kill]")
+{
+    auto child = scope_exit_v1::process_guard::spawn({"/bin/sleep", "60"});
+    child.kill(SIGTERM);
+    REQUIRE(child.wait() == -SIGTERM);
+
+    // killing a reaped child is a no-op
+    child.kill();
+}
+
+TEST_CASE("process_guard adopts forked child", "[process_guard][adopt]")
+{
+    pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        ::_exit(7);
+    }
+
+    scope_exit_v1::process_guard child{pid};
+    REQUIRE(child.wait() == 7);
+}
+
+TEST_CASE("process_guard spawn failure throws", "[process_guard][errors]")
+{
+    REQUIRE_THROWS_AS(scope_exit_v1::process_guard::spawn({"/nonexistent/program"}), std::system_error);
+
+    scope_exit_v1::process_group_guard group;
+    REQUIRE_THROWS_AS(group.spawn({"/nonexistent/program"}), std::system_error);
+    REQUIRE(group.size() == 0);
+}
+
+TEST_CASE("process_guard rejects a pid it cannot track", "[process_guard][errors]")
+{
+    REQUIRE_THROWS_AS(scope_exit_v1::process_guard{-1}, std::system_error);
+
+    scope_exit_v1::process_group_guard group;
+    REQUIRE_THROWS_AS(group.adopt(-1), std::system_error);
+    REQUIRE(group.size() == 0);
+}
+
+TEST_CASE("process_group_guard reaps batch", "[process_group_guard][basic]")
+{
+    SECTION("reaps all children on success")
+    {
+        std::set<pid_t> pids;
+        {
+            scope_exit_v1::process_group_guard group;
+            for (int i = 0; i != 8; ++i)
+            {
+                pids.insert(group.spawn({"/bin/true"}));
+            }
+            REQUIRE(group.size() == 8);
+        }
+
+        for (pid_t pid : pids)
+        {
+            REQUIRE(is_reaped(pid));
+        }
+    }
+
+    SECTION("wait_all reports every child")
+    {
+        scope_exit_v1::process_group_guard group;
+        std::set<pid_t> pids;
+        pids.insert(group.spawn({"/bin/sleep", "0.05"}));
+        pids.insert(group.spawn({"/bin/true"}));
+        pids.insert(group.spawn({"/bin/false"}));
+
+        auto reaped = group.wait_all();
+        REQUIRE(reaped.size() == 3);
+        REQUIRE(group.size() == 0);
+
+        std::set<pid_t> reaped_pids;
+        int failures = 0;
+        for (auto const & [pid, status] : reaped)
+        {
+            reaped_pids.insert(pid);
+            failures += status != 0;
+        }
+        REQUIRE(reaped_pids == pids);
+        REQUIRE(failures == 1);
+    }
+
+    SECTION("empty group")
+    {
+        scope_exit_v1::process_group_guard group;
+        REQUIRE(group.wait_all().empty());
+    }
+}
+
+TEST_CASE("process_group_guard kills batch on failure", "[process_group_guard][failure]")
+{
+    std::set<pid_t> pids;
+
+    try
+    {
+        scope_exit_v1::process_group_guard group;
+        for (int i = 0; i != 4; ++i)
+        {
+            pids.insert(group.spawn({"/bin/sleep", "60"}));
+        }
+        throw std::runtime_error("fail");
+    }
+    catch (std::runtime_error const &)
+    {
+    }
+
+    REQUIRE(pids.size() == 4);
+    for (pid_t pid : pids)
+    {
+        REQUIRE(is_reaped(pid));
+    }
+}
@@ -0,0 +1,183 @@
+#include <scope_exit/rcu_guard.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::rcu_cell;
+
+namespace
+{
+
+std::atomic<int> live_configs{0};
+
+struct config
+{
+    config(int a_, int b_)
+        : a{a_}
+        , b{b_}
+    {
+        ++live_configs;
+    }
+
+    config(config const & other)
+        : a{other.a}
+        , b{other.b}
+        , name{other.name}
+    {
+        ++live_configs;
+    }
+
+    ~config() { --live_configs; }
+
+    int a;
+    int b;
+    std::string name;
+};
+
+}  // namespace
+
+TEST_CASE("rcu_cell update guards", "[rcu_guard][basic]")
+{
+    rcu_cell<config> cell{1, 1};
+
+    SECTION("a successful update is published")
+    {
+        {
+            auto draft = cell.update();
+            draft->a = 2;
+            REQUIRE(cell.read()->a == 1);
+        }
+        REQUIRE(cell.read()->a == 2);
+        REQUIRE(cell.read()->b == 1);
+    }
+
+    SECTION("a failed update is dropped")
+    {
+        REQUIRE_THROWS_AS(
+            [&] {
+                auto draft = cell.update();
+                draft->a = 3;
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE(cell.read()->a == 1);
+    }
+
+    SECTION("a cancelled update is dropped")
+    {
+        {
+            auto draft = cell.update();
+            draft->a = 4;
+            draft.cancel();
+        }
+        REQUIRE(cell.read()->a == 1);
+    }
+
+    SECTION("updates start from the latest object")
+    {
+        for (int i = 0; i != 10; ++i)
+        {
+            auto draft = cell.update();
+            draft->a += 1;
+        }
+        REQUIRE(cell.read()->a == 11);
+    }
+
+    SECTION("store replaces the object")
+    {
+        cell.store(std::make_unique<config>(7, 8));
+        auto cfg = cell.read();
+        REQUIRE(cfg->a == 7);
+        REQUIRE((*cfg).b == 8);
+    }
+}
+
+TEST_CASE("rcu_cell retires old objects after readers leave", "[rcu_guard][reclaim]")
+{
+    scope_exit_v1::detail::rcu::synchronize();
+    int const baseline = live_configs.load();
+    {
+        rcu_cell<config> cell{0, 0};
+
+        auto pinned = cell.read();
+        config const * old = pinned.get();
+        {
+            auto draft = cell.update();
+            draft->a = 1;
+        }
+        scope_exit_v1::detail::rcu::reclaim();
+        // the pinned reader keeps the old object alive
+        REQUIRE(old->a == 0);
+        REQUIRE(live_configs.load() == baseline + 2);
+    }
+    scope_exit_v1::detail::rcu::synchronize();
+    REQUIRE(live_configs.load() == baseline);
+}
+
+TEST_CASE("rcu_cell with concurrent readers", "[rcu_guard][threads]")
+{
+    rcu_cell<config> cell{0, 0};
+    constexpr int readers = 3;
+    constexpr int updates = 2000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> backwards{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r != readers; ++r)
+    {
+        threads.emplace_back([&] {
+            int last = 0;
+            while (!done.load())
+            {
+                auto cfg = cell.read();
+                if (cfg->a != cfg->b)
+                {
+                    ++torn;
+                }
+                if (cfg->a < last)
+                {
+                    ++backwards;
+                }
+                last = cfg->a;
+            }
+        });
+    }
+
+    std::thread writer{[&] {
+        for (int i = 1; i <= updates; ++i)
+        {
+            try
+            {
+                auto draft = cell.update();
+                draft->a = i;
+                if (i % 7 == 0)
+                {
+                    throw std::runtime_error{"rollback"};
+                }
+                draft->b = i;
+            }
+            catch (std::runtime_error const &)
+            {
+            }
+        }
+    }};
+
+    writer.join();
+    done.store(true);
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+
+    REQUIRE(torn.load() == 0);
+    REQUIRE(backwards.load() == 0);
+    REQUIRE(cell.read()->a == updates);
+}
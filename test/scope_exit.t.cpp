@@ -480,3 +480,42 @@ TEST_CASE("edge cases and control flow", "[scope_exit][edge_cases]")
         REQUIRE(order == std::vector<std::string>{"if_block", "outer"});
     }
 }
+
+TEST_CASE("guard layout does not depend on the language standard", "[scope_exit][scope_success][scope_failure][size]")
+{
+    // translation units built as C++17 and C++20 must agree on the guard types they share
+    auto action = [] {};
+    using action_type = decltype(action);
+    struct reference_layout
+    {
+        action_type action;
+        int uncaught_count;
+    };
+    STATIC_REQUIRE(sizeof(scope_exit_v1::detail::scope_success_guard<action_type>) == sizeof(reference_layout));
+    STATIC_REQUIRE(sizeof(scope_exit_v1::detail::scope_failure_guard<action_type>) == sizeof(reference_layout));
+}
+
+#if __cplusplus >= 202002L
+namespace
+{
+
+constexpr int guarded_sum()
+{
+    int sum = 0;
+    {
+        scope(exit) { sum += 1; };
+        scope(success) { sum += 10; };
+        scope(failure) { sum += 100; };
+    }
+    return sum;
+}
+
+}  // namespace
+
+TEST_CASE("guards in constant expressions", "[scope_exit][scope_success][scope_failure][constexpr]")
+{
+    // no exception is in flight during constant evaluation: exit and success guards run, failure guards do not
+    STATIC_REQUIRE(guarded_sum() == 11);
+    REQUIRE(guarded_sum() == 11);
+}
+#endif
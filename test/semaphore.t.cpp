@@ -0,0 +1,232 @@
+#include <scope_exit/semaphore.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::admission_semaphore;
+
+TEST_CASE("admission_semaphore permits", "[semaphore][basic]")
+{
+    admission_semaphore sem{3};
+
+    SECTION("permit is returned on scope exit")
+    {
+        {
+            auto permit = sem.acquire();
+            REQUIRE(permit);
+            REQUIRE(permit.count() == 1);
+            REQUIRE(sem.available() == 2);
+        }
+        REQUIRE(sem.available() == 3);
+    }
+
+    SECTION("permit is returned on exception")
+    {
+        try
+        {
+            auto permit = sem.acquire(2);
+            REQUIRE(sem.available() == 1);
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(sem.available() == 3);
+    }
+
+    SECTION("batch acquire is all or nothing")
+    {
+        auto a = sem.acquire(2);
+        auto b = sem.try_acquire(2);
+        REQUIRE_FALSE(b);
+        REQUIRE(b.count() == 0);
+        REQUIRE(sem.available() == 1);
+
+        auto c = sem.try_acquire(1);
+        REQUIRE(c);
+        REQUIRE(sem.available() == 0);
+    }
+
+    SECTION("early release and move")
+    {
+        auto a = sem.acquire(3);
+        auto b = std::move(a);
+        REQUIRE_FALSE(a);
+        REQUIRE(sem.available() == 0);
+
+        b.release();
+        b.release();
+        REQUIRE(sem.available() == 3);
+    }
+
+    SECTION("batch release without guard")
+    {
+        auto a = sem.try_acquire(3);
+        REQUIRE(a);
+        sem.release(2);
+        REQUIRE(sem.available() == 2);
+        sem.acquire(2).release();
+    }
+
+    SECTION("requests no limit can satisfy are rejected")
+    {
+        REQUIRE_THROWS_AS(sem.acquire(4), std::invalid_argument);
+        REQUIRE_THROWS_AS(sem.try_acquire(4), std::invalid_argument);
+        REQUIRE_THROWS_AS(sem.acquire(0), std::invalid_argument);
+        REQUIRE_THROWS_AS(sem.try_acquire(-1), std::invalid_argument);
+        REQUIRE(sem.available() == 3);
+
+        admission_semaphore adaptive{2, {1, 4, 1, 0.5}};
+        REQUIRE_FALSE(adaptive.try_acquire(4));  // above the current limit, within the maximum
+        REQUIRE_THROWS_AS(adaptive.try_acquire(5), std::invalid_argument);
+        REQUIRE_THROWS_AS(adaptive.acquire(3), std::invalid_argument);  // waiting could never end
+        REQUIRE(adaptive.available() == 2);
+    }
+}
+
+TEST_CASE("admission_semaphore blocks until permits are released", "[semaphore][blocking]")
+{
+    admission_semaphore sem{2};
+    auto held = sem.acquire(2);
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter{[&] {
+        auto permit = sem.acquire(2);
+        acquired = true;
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    REQUIRE_FALSE(acquired);
+
+    held.release();
+    waiter.join();
+    REQUIRE(acquired);
+    REQUIRE(sem.available() == 2);
+}
+
+TEST_CASE("admission_semaphore bounds concurrency under contention", "[semaphore][stress]")
+{
+    constexpr int limit = 3;
+    admission_semaphore sem{limit};
+    std::atomic<int> inside{0};
+    std::atomic<int> peak{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 8; ++t)
+    {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i != 2000; ++i)
+            {
+                auto permit = sem.acquire(1 + (i + t) % 2);
+                int now = inside.fetch_add(permit.count()) + permit.count();
+                int prev = peak.load();
+                while (now > prev && !peak.compare_exchange_weak(prev, now))
+                {
+                }
+                inside.fetch_sub(permit.count());
+            }
+        });
+    }
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+
+    REQUIRE(peak <= limit);
+    REQUIRE(sem.available() == limit);
+}
+
+TEST_CASE("adaptive admission_semaphore", "[semaphore][aimd]")
+{
+    scope_exit_v1::aimd_options options;
+    options.min_limit = 2;
+    options.max_limit = 10;
+    admission_semaphore sem{8, options};
+
+    SECTION("failure halves the limit")
+    {
+        try
+        {
+            auto permit = sem.acquire();
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+        REQUIRE(sem.limit() == 4);
+        REQUIRE(sem.available() == 4);
+
+        sem.record_failure();
+        sem.record_failure();
+        REQUIRE(sem.limit() == 2);
+        REQUIRE(sem.available() == 2);
+    }
+
+    SECTION("limit shrinks below permits in use")
+    {
+        auto held = sem.acquire(6);
+        sem.record_failure();
+        REQUIRE(sem.limit() == 4);
+        REQUIRE(sem.available() == -2);
+        REQUIRE_FALSE(sem.try_acquire());
+
+        held.release();
+        REQUIRE(sem.available() == 4);
+    }
+
+    SECTION("a waiter gives up when the limit shrinks below its request")
+    {
+        auto held = sem.acquire(4);
+
+        std::atomic<bool> rejected{false};
+        std::thread waiter{[&] {
+            try
+            {
+                auto permit = sem.acquire(6);
+            }
+            catch (std::invalid_argument const &)
+            {
+                rejected = true;
+            }
+        }};
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        REQUIRE_FALSE(rejected);
+
+        sem.record_failure();  // 8 -> 4
+        waiter.join();
+        REQUIRE(rejected);
+
+        held.release();
+        REQUIRE(sem.available() == sem.limit());
+    }
+
+    SECTION("successes grow the limit additively up to the maximum")
+    {
+        for (int i = 0; i != 8; ++i)
+        {
+            auto permit = sem.acquire();
+        }
+        REQUIRE(sem.limit() == 9);
+        REQUIRE(sem.available() == 9);
+
+        for (int i = 0; i != 100; ++i)
+        {
+            auto permit = sem.acquire();
+        }
+        REQUIRE(sem.limit() == 10);
+    }
+
+    SECTION("fixed semaphore ignores outcomes")
+    {
+        admission_semaphore fixed{4};
+        fixed.record_failure();
+        fixed.record_success();
+        REQUIRE(fixed.limit() == 4);
+    }
+}
@@ -0,0 +1,203 @@
+#include <scope_exit/shared_segment.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/wait.h>
+
+using scope_exit_v1::shared_segment;
+
+namespace
+{
+
+constexpr std::size_t segment_size = 1 << 20;
+
+void fill(shared_segment & segment)
+{
+    auto * bytes = static_cast<unsigned char *>(segment.data());
+    for (std::size_t i = 0; i != segment.size(); ++i)
+    {
+        bytes[i] = static_cast<unsigned char>(i * 31);
+    }
+}
+
+bool holds_pattern(void const * data, std::size_t size)
+{
+    auto const * bytes = static_cast<unsigned char const *>(data);
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        if (bytes[i] != static_cast<unsigned char>(i * 31))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Run `check` in a forked child and return its exit code: 0 if it returned true, 1 if it returned false, 2 if it
+/// threw.  The child must not let an exception escape into the copy of the test runner.
+template <typename Check>
+int in_child(Check && check)
+{
+    pid_t const pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        try
+        {
+            ::_exit(check() ? 0 : 1);
+        }
+        catch (...)
+        {
+            ::_exit(2);
+        }
+    }
+    int status = 0;
+    REQUIRE(::waitpid(pid, &status, 0) == pid);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// The segment cannot be changed through the file or a new mapping.
+bool is_immutable(int fd)
+{
+    char byte = 0;
+    bool const write_fails = ::pwrite(fd, &byte, 1, 0) < 0 && errno == EPERM;
+    bool const resize_fails = ::ftruncate(fd, 0) != 0 && errno == EPERM;
+    void * writable = ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    bool const map_fails = writable == MAP_FAILED && errno == EPERM;
+    return write_fails && resize_fails && map_fails;
+}
+
+}  // namespace
+
+TEST_CASE("shared_segment seals on success", "[shared_segment][basic]")
+{
+    shared_segment segment{segment_size};
+    REQUIRE(segment);
+    REQUIRE(segment.size() == segment_size);
+    REQUIRE_FALSE(segment.sealed());
+
+    {
+        scope(sealed, segment);
+        fill(segment);
+    }
+
+    REQUIRE(segment.sealed());
+    REQUIRE(segment.data() != nullptr);
+    REQUIRE(holds_pattern(segment.data(), segment_size));
+    REQUIRE(is_immutable(segment.fd()));
+}
+
+TEST_CASE("shared_segment is torn down on failure", "[shared_segment][failure]")
+{
+    shared_segment segment{segment_size};
+    int const fd = segment.fd();
+
+    try
+    {
+        scope(sealed, segment);
+        fill(segment);
+        throw std::runtime_error("render failed");
+    }
+    catch (std::runtime_error const &)
+    {
+    }
+
+    REQUIRE_FALSE(segment);
+    REQUIRE(segment.fd() == -1);
+    REQUIRE(segment.data() == nullptr);
+    REQUIRE(::fcntl(fd, F_GETFD) == -1);
+    REQUIRE(errno == EBADF);
+}
+
+TEST_CASE("shared_segment hands off to a child process", "[shared_segment][fork]")
+{
+    shared_segment segment{segment_size};
+    {
+        scope(sealed, segment);
+        fill(segment);
+    }
+
+    SECTION("the child sees the contents and cannot change them")
+    {
+        int const fd = segment.fd();
+        REQUIRE(in_child([fd] {
+            auto received = shared_segment::attach(::dup(fd));
+            return received.sealed() && received.size() == segment_size &&
+                   holds_pattern(received.data(), received.size()) && is_immutable(received.fd());
+        }) == 0);
+    }
+
+    SECTION("attaching an unsealed segment maps it writable")
+    {
+        shared_segment draft{segment_size};
+        int const fd = draft.fd();
+        REQUIRE(in_child([fd] {
+            auto received = shared_segment::attach(::dup(fd));
+            static_cast<char *>(received.data())[0] = 'x';
+            return !received.sealed();
+        }) == 0);
+        REQUIRE(static_cast<char *>(draft.data())[0] == 'x');
+    }
+}
+
+TEST_CASE("shared_segment cannot seal while a child maps it writable", "[shared_segment][fork]")
+{
+    shared_segment segment{segment_size};
+    fill(segment);
+
+    int ready[2];
+    int release[2];
+    REQUIRE(::pipe(ready) == 0);
+    REQUIRE(::pipe(release) == 0);
+    pid_t const pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // the inherited writable mapping blocks F_SEAL_WRITE until the child exits
+        char byte = 0;
+        bool const handshake = ::write(ready[1], &byte, 1) == 1 && ::read(release[0], &byte, 1) == 1;
+        ::_exit(handshake ? 0 : 1);
+    }
+    char byte = 0;
+    REQUIRE(::read(ready[0], &byte, 1) == 1);
+
+    auto seal_in_scope = [&] {
+        scope(sealed, segment);
+    };
+    REQUIRE_THROWS_AS(seal_in_scope(), std::system_error);
+    REQUIRE(segment);
+    REQUIRE_FALSE(segment.sealed());
+    REQUIRE(holds_pattern(segment.data(), segment_size));
+
+    REQUIRE(::write(release[1], &byte, 1) == 1);
+    REQUIRE(::waitpid(pid, nullptr, 0) == pid);
+    seal_in_scope();
+    REQUIRE(segment.sealed());
+
+    for (int fd : {ready[0], ready[1], release[0], release[1]})
+    {
+        ::close(fd);
+    }
+}
+
+TEST_CASE("shared_segment falls back from huge pages", "[shared_segment][huge]")
+{
+    std::size_t const size = 3 << 20;
+    shared_segment segment{size, shared_segment::pages::huge};
+    REQUIRE(segment.size() == size);
+    std::memset(segment.data(), 'h', size);
+    {
+        scope(sealed, segment);
+    }
+    REQUIRE(segment.sealed());
+    REQUIRE(static_cast<char const *>(segment.data())[size - 1] == 'h');
+    if (!segment.huge_pages())
+    {
+        WARN("no huge pages reserved; the segment uses normal pages");
+    }
+}
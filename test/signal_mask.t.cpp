@@ -0,0 +1,175 @@
+#include <scope_exit/signal_mask.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <csignal>
+#include <stdexcept>
+#include <thread>
+
+#include <pthread.h>
+
+using scope_exit_v1::signal_block_guard;
+using scope_exit_v1::signal_mask;
+
+namespace
+{
+
+bool kernel_blocks(int signal)
+{
+    sigset_t set;
+    ::pthread_sigmask(SIG_BLOCK, nullptr, &set);
+    return sigismember(&set, signal) == 1;
+}
+
+volatile std::sig_atomic_t usr1_delivered = 0;
+
+void on_usr1(int) { usr1_delivered = 1; }
+
+}  // namespace
+
+TEST_CASE("scope(signals_blocked) blocks for the scope", "[signal_mask][basic]")
+{
+    REQUIRE_FALSE(kernel_blocks(SIGUSR1));
+
+    SECTION("signals are blocked inside and restored after")
+    {
+        {
+            scope(signals_blocked, SIGUSR1, SIGUSR2);
+            REQUIRE(kernel_blocks(SIGUSR1));
+            REQUIRE(kernel_blocks(SIGUSR2));
+            REQUIRE(signal_mask::local().blocked() & signal_mask::bit(SIGUSR1));
+        }
+        REQUIRE_FALSE(kernel_blocks(SIGUSR1));
+        REQUIRE_FALSE(kernel_blocks(SIGUSR2));
+    }
+
+    SECTION("signal numbers out of range are rejected")
+    {
+        REQUIRE_THROWS_AS(signal_block_guard({0}), std::invalid_argument);
+        REQUIRE_THROWS_AS(signal_block_guard({SIGUSR1, NSIG}), std::invalid_argument);
+        REQUIRE_THROWS_AS(signal_mask::bit(-1), std::invalid_argument);
+        REQUIRE(signal_mask::bit(NSIG - 1) != 0);
+        REQUIRE_FALSE(kernel_blocks(SIGUSR1));
+    }
+
+    SECTION("the mask is restored on exception")
+    {
+        REQUIRE_THROWS_AS(
+            [] {
+                scope(signals_blocked, SIGUSR1);
+                throw std::runtime_error{"boom"};
+            }(),
+            std::runtime_error);
+        REQUIRE_FALSE(kernel_blocks(SIGUSR1));
+    }
+
+    SECTION("a signal raised inside is delivered after the scope")
+    {
+        struct sigaction action = {};
+        struct sigaction previous = {};
+        action.sa_handler = on_usr1;
+        ::sigaction(SIGUSR1, &action, &previous);
+        usr1_delivered = 0;
+        {
+            scope(signals_blocked, SIGUSR1);
+            ::raise(SIGUSR1);
+            REQUIRE(usr1_delivered == 0);
+        }
+        REQUIRE(usr1_delivered == 1);
+        ::sigaction(SIGUSR1, &previous, nullptr);
+    }
+
+    SECTION("sigset_t overload")
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGHUP);
+        {
+            signal_block_guard guard{set};
+            REQUIRE(kernel_blocks(SIGHUP));
+        }
+        REQUIRE_FALSE(kernel_blocks(SIGHUP));
+    }
+}
+
+TEST_CASE("signal mask cache skips redundant syscalls", "[signal_mask][cache]")
+{
+    auto & mask = signal_mask::local();
+    mask.refresh();
+
+    SECTION("nested guards collapse into one syscall pair")
+    {
+        auto before = mask.syscalls();
+        {
+            scope(signals_blocked, SIGUSR1, SIGUSR2);
+            {
+                scope(signals_blocked, SIGUSR1);
+                {
+                    scope(signals_blocked, SIGUSR2, SIGUSR1);
+                    REQUIRE(kernel_blocks(SIGUSR2));
+                }
+            }
+            REQUIRE(kernel_blocks(SIGUSR1));
+        }
+        REQUIRE(mask.syscalls() - before == 2);
+        REQUIRE_FALSE(kernel_blocks(SIGUSR1));
+    }
+
+    SECTION("an inner guard adding signals restores only its own")
+    {
+        auto before = mask.syscalls();
+        {
+            scope(signals_blocked, SIGUSR1);
+            {
+                scope(signals_blocked, SIGUSR2);
+                REQUIRE(kernel_blocks(SIGUSR1));
+                REQUIRE(kernel_blocks(SIGUSR2));
+            }
+            REQUIRE(kernel_blocks(SIGUSR1));
+            REQUIRE_FALSE(kernel_blocks(SIGUSR2));
+        }
+        REQUIRE(mask.syscalls() - before == 4);
+    }
+
+    SECTION("unblockable signals are left out of the cache")
+    {
+        auto before = mask.syscalls();
+        {
+            scope(signals_blocked, SIGKILL, SIGSTOP);
+        }
+        REQUIRE(mask.syscalls() == before);
+    }
+
+    SECTION("refresh picks up external changes")
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGUSR2);
+        ::pthread_sigmask(SIG_BLOCK, &set, nullptr);
+        mask.refresh();
+        REQUIRE(mask.blocked() & signal_mask::bit(SIGUSR2));
+
+        auto before = mask.syscalls();
+        {
+            scope(signals_blocked, SIGUSR2);
+        }
+        REQUIRE(mask.syscalls() == before);
+
+        ::pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+        mask.refresh();
+    }
+
+    SECTION("the cache is per thread")
+    {
+        scope(signals_blocked, SIGUSR1);
+        bool blocked_in_thread = false;
+        bool cached_in_thread = true;
+        std::thread{[&] {
+            // a new thread inherits the creating thread's mask
+            blocked_in_thread = kernel_blocks(SIGUSR1);
+            cached_in_thread = (signal_mask::local().blocked() & signal_mask::bit(SIGUSR1)) != 0;
+        }}.join();
+        REQUIRE(blocked_in_thread);
+        REQUIRE(cached_in_thread);
+    }
+}
@@ -0,0 +1,193 @@
+#include <scope_exit/span.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::span_exporter;
+using scope_exit_v1::span_guard;
+using scope_exit_v1::span_record;
+using scope_exit_v1::span_stack;
+
+namespace
+{
+
+std::vector<span_record> drain(span_exporter & exporter)
+{
+    std::vector<span_record> spans;
+    exporter.drain([&](span_record const & r) { spans.push_back(r); });
+    return spans;
+}
+
+}  // namespace
+
+TEST_CASE("scope(span) records nested spans", "[span][basic]")
+{
+    drain(span_exporter::global());
+
+    SECTION("spans complete innermost first with parent links")
+    {
+        {
+            scope(span, "outer");
+            REQUIRE(span_stack::local().depth() == 1);
+            REQUIRE(std::strcmp(span_stack::local().current()->name, "outer") == 0);
+            {
+                scope(span, "inner");
+                REQUIRE(span_stack::local().depth() == 2);
+            }
+        }
+        REQUIRE(span_stack::local().depth() == 0);
+        REQUIRE(span_stack::local().current() == nullptr);
+
+        auto spans = drain(span_exporter::global());
+        REQUIRE(spans.size() == 2);
+        REQUIRE(std::strcmp(spans[0].name, "inner") == 0);
+        REQUIRE(std::strcmp(spans[1].name, "outer") == 0);
+        REQUIRE(spans[0].parent_id == spans[1].id);
+        REQUIRE(spans[1].parent_id == 0);
+        REQUIRE(spans[0].depth == 1);
+        REQUIRE(spans[1].start_ns <= spans[0].start_ns);
+        REQUIRE(spans[0].end_ns <= spans[1].end_ns);
+        REQUIRE_FALSE(spans[0].failed);
+        REQUIRE(spans[0].id != spans[1].id);
+    }
+
+    SECTION("span left by exception is marked failed")
+    {
+        try
+        {
+            scope(span, "ok");
+            {
+                scope(span, "throws");
+                throw std::runtime_error("error");
+            }
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+
+        auto spans = drain(span_exporter::global());
+        REQUIRE(spans.size() == 2);
+        REQUIRE(spans[0].failed);
+        REQUIRE(spans[1].failed);
+    }
+
+    SECTION("span inside a catch handler is not failed")
+    {
+        try
+        {
+            throw std::runtime_error("error");
+        }
+        catch (std::runtime_error const &)
+        {
+            scope(span, "handler");
+        }
+
+        auto spans = drain(span_exporter::global());
+        REQUIRE(spans.size() == 1);
+        REQUIRE_FALSE(spans[0].failed);
+    }
+}
+
+TEST_CASE("span_exporter", "[span][exporter]")
+{
+    SECTION("full queue drops spans")
+    {
+        span_exporter exporter{4};
+        for (int i = 0; i != 6; ++i)
+        {
+            span_guard g{"s", exporter};
+        }
+        REQUIRE(exporter.dropped() == 2);
+        REQUIRE(drain(exporter).size() == 4);
+    }
+
+    SECTION("spans from many threads")
+    {
+        span_exporter exporter{1 << 12};
+        std::vector<std::thread> threads;
+        for (int t = 0; t != 4; ++t)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i != 100; ++i)
+                {
+                    span_guard g{"worker", exporter};
+                    span_guard nested{"nested", exporter};
+                }
+            });
+        }
+        for (auto & t : threads)
+        {
+            t.join();
+        }
+        REQUIRE(drain(exporter).size() == 800);
+    }
+
+    SECTION("stack overflow is counted")
+    {
+        span_exporter exporter{1 << 8};
+        auto before = span_stack::local().overflowed();
+        std::vector<std::unique_ptr<span_guard>> guards;
+        for (std::uint32_t i = 0; i != span_stack::capacity + 3; ++i)
+        {
+            guards.push_back(std::make_unique<span_guard>("deep", exporter));
+        }
+        while (!guards.empty())
+        {
+            guards.pop_back();
+        }
+        REQUIRE(span_stack::local().overflowed() - before == 3);
+        REQUIRE(drain(exporter).size() == span_stack::capacity);
+    }
+}
+
+TEST_CASE("file_span_sink writes JSON lines", "[span][sink]")
+{
+    span_exporter exporter{16};
+    {
+        span_guard g{"request", exporter};
+    }
+
+    std::FILE * file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    scope(exit) { std::fclose(file); };
+
+    scope_exit_v1::file_span_sink sink{file};
+    REQUIRE(sink.flush(exporter) == 1);
+
+    std::rewind(file);
+    char line[512] = {};
+    REQUIRE(std::fgets(line, sizeof line, file) != nullptr);
+    std::string text{line};
+    REQUIRE(text.find("\"name\":\"request\"") != std::string::npos);
+    REQUIRE(text.find("\"error\":false") != std::string::npos);
+    REQUIRE(text.back() == '\n');
+}
+
+TEST_CASE("file_span_sink escapes span names", "[span][sink]")
+{
+    span_exporter exporter{16};
+    {
+        span_guard g{"say \"hi\"\\\n\x01", exporter};
+    }
+
+    std::FILE * file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    scope(exit) { std::fclose(file); };
+
+    scope_exit_v1::file_span_sink sink{file};
+    REQUIRE(sink.flush(exporter) == 1);
+
+    std::rewind(file);
+    char line[512] = {};
+    REQUIRE(std::fgets(line, sizeof line, file) != nullptr);
+    std::string text{line};
+    REQUIRE(text.find(R"("name":"say \"hi\"\\\n\u0001",)") != std::string::npos);
+    REQUIRE(text.find('\n') == text.size() - 1);
+}
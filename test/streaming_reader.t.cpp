@@ -0,0 +1,264 @@
+#include <scope_exit/streaming_reader.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using scope_exit_v1::streaming_reader;
+
+namespace
+{
+
+constexpr std::size_t file_size = 8 << 20;
+
+/// A file of `file_size` bytes in the working directory (not /tmp, which may be tmpfs and ignore the advice).
+class test_file
+{
+public:
+    test_file()
+    {
+        char name[] = "streaming_reader.XXXXXX";
+        fd_ = ::mkstemp(name);
+        REQUIRE(fd_ >= 0);
+        ::unlink(name);
+
+        std::vector<char> block(1 << 20);
+        for (std::size_t i = 0; i != block.size(); ++i)
+        {
+            block[i] = static_cast<char>(i * 7);
+        }
+        for (std::size_t written = 0; written != file_size; written += block.size())
+        {
+            REQUIRE(::write(fd_, block.data(), block.size()) == static_cast<ssize_t>(block.size()));
+        }
+        ::fsync(fd_);
+        ::lseek(fd_, 0, SEEK_SET);
+    }
+
+    test_file(test_file const &) = delete;
+    test_file & operator=(test_file const &) = delete;
+
+    ~test_file() { ::close(fd_); }
+
+    int fd() const { return fd_; }
+
+    /// Evict the file; false if the file system keeps it cached anyway.
+    bool evict() const
+    {
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+        return resident_pages() == 0;
+    }
+
+    /// Cached pages among the `size` bytes of the file from `offset` (page aligned) on.
+    std::size_t resident_pages(std::size_t size = file_size, off_t offset = 0) const
+    {
+        if (size == 0)
+        {
+            return 0;
+        }
+        void * map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, offset);
+        REQUIRE(map != MAP_FAILED);
+        std::size_t const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> resident((size + page - 1) / page);
+        ::mincore(map, size, resident.data());
+        ::munmap(map, size);
+
+        std::size_t n = 0;
+        for (auto r : resident)
+        {
+            n += r & 1;
+        }
+        return n;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+std::size_t read_all(streaming_reader & reader, std::size_t chunk = 1 << 16)
+{
+    std::vector<char> buffer(chunk);
+    std::size_t total = 0;
+    while (auto n = reader.read(buffer.data(), buffer.size()))
+    {
+        total += n;
+    }
+    return total;
+}
+
+}  // namespace
+
+TEST_CASE("streaming_reader tracks what it reads", "[streaming_reader][basic]")
+{
+    test_file file;
+    std::size_t const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    SECTION("reads return the file contents and merge into one range")
+    {
+        streaming_reader reader{file.fd()};
+        char buffer[100];
+        REQUIRE(reader.read(buffer, sizeof buffer) == sizeof buffer);
+        REQUIRE(buffer[3] == static_cast<char>(21));
+        REQUIRE(reader.read(buffer, sizeof buffer) == sizeof buffer);
+
+        REQUIRE(reader.bytes_read() == 200);
+        REQUIRE(reader.pending_ranges().size() == 1);
+        REQUIRE(reader.pending_ranges()[0] == std::pair<off_t, off_t>{0, 200});
+    }
+
+    SECTION("seeking between reads is not reading")
+    {
+        streaming_reader reader{file.fd()};
+        char buffer[100];
+        reader.read(buffer, sizeof buffer);
+        ::lseek(file.fd(), 10000, SEEK_SET);
+        reader.read(buffer, sizeof buffer);
+
+        REQUIRE(reader.bytes_read() == 200);
+        REQUIRE(reader.pending_ranges().size() == 2);
+        REQUIRE(reader.pending_ranges()[1] == std::pair<off_t, off_t>{10000, 10100});
+    }
+
+    SECTION("scattered reads keep disjoint ranges until they touch")
+    {
+        streaming_reader reader{file.fd()};
+        char buffer[100];
+        reader.pread(buffer, sizeof buffer, 1000);
+        reader.pread(buffer, sizeof buffer, 0);
+        reader.pread(buffer, sizeof buffer, 500);
+        REQUIRE(reader.pending_ranges().size() == 3);
+
+        reader.pread(buffer, sizeof buffer, 100);  // touches [0, 100)
+        reader.note_read(200, 800);                // fills the gap up to 1000
+        REQUIRE(reader.pending_ranges().size() == 1);
+        REQUIRE(reader.pending_ranges()[0] == std::pair<off_t, off_t>{0, 1100});
+    }
+
+    SECTION("drop keeps a partly read last page")
+    {
+        streaming_reader reader{file.fd()};
+        std::vector<char> buffer(page + 10);
+        reader.read(buffer.data(), buffer.size());
+        reader.drop();
+
+        REQUIRE(reader.bytes_dropped() == page);
+        REQUIRE(reader.pending_ranges().size() == 1);
+        REQUIRE(reader.pending_ranges()[0] == std::pair<off_t, off_t>(page, page + 10));
+    }
+
+    SECTION("a byte budget drops incrementally")
+    {
+        streaming_reader reader{file.fd(), 1 << 20};
+        REQUIRE(read_all(reader) == file_size);
+        REQUIRE(reader.bytes_dropped() == file_size);
+        REQUIRE(reader.pending_ranges().empty());
+    }
+
+    SECTION("read errors throw")
+    {
+        streaming_reader reader{-1};
+        char buffer[1];
+        REQUIRE_THROWS_AS(reader.read(buffer, 1), std::system_error);
+    }
+}
+
+TEST_CASE("streaming_reader evicts what the scope read", "[streaming_reader][page_cache]")
+{
+    test_file file;
+    if (!file.evict())
+    {
+        WARN("the file system ignores POSIX_FADV_DONTNEED; residency not checked");
+        return;
+    }
+
+    SECTION("pages read through the reader are dropped on exit")
+    {
+        {
+            streaming_reader reader{file.fd()};
+            read_all(reader);
+            REQUIRE(file.resident_pages() > 0);
+        }
+        REQUIRE(file.resident_pages() == 0);
+    }
+
+    SECTION("a byte budget drops behind the reader while streaming")
+    {
+        // ahead of the offset the readahead window stays cached, its size is up to the device
+        std::size_t resident_behind = 0;
+        {
+            streaming_reader reader{file.fd(), 1 << 20};
+            std::vector<char> buffer(1 << 16);
+            while (reader.read(buffer.data(), buffer.size()) != 0)
+            {
+                resident_behind += file.resident_pages(reader.bytes_dropped());
+            }
+            REQUIRE(reader.bytes_dropped() == file_size);
+        }
+        REQUIRE(resident_behind == 0);
+        REQUIRE(file.resident_pages() == 0);
+    }
+
+    SECTION("scope(streaming) drops reads made on the descriptor directly")
+    {
+        {
+            scope(streaming, file.fd());
+            std::vector<char> buffer(1 << 20);
+            while (::read(file.fd(), buffer.data(), buffer.size()) > 0)
+            {
+            }
+        }
+        REQUIRE(file.resident_pages() == 0);
+    }
+
+    SECTION("a forward seek leaves the skipped range cached")
+    {
+        // another user of the file keeps [1 MiB, 5 MiB) cached
+        constexpr std::size_t skipped_offset = 1 << 20;
+        constexpr std::size_t skipped_size = 4 << 20;
+        std::vector<char> buffer(skipped_size);
+        REQUIRE(::pread(file.fd(), buffer.data(), skipped_size, skipped_offset) ==
+                static_cast<ssize_t>(skipped_size));
+        std::size_t const skipped_pages = file.resident_pages(skipped_size, skipped_offset);
+        REQUIRE(skipped_pages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) == skipped_size);
+
+        auto read_around_skipped = [&](auto read) {
+            read(1 << 16);
+            ::lseek(file.fd(), 6 << 20, SEEK_SET);
+            read(1 << 16);
+        };
+
+        ::lseek(file.fd(), 0, SEEK_SET);
+        {
+            streaming_reader reader{file.fd()};
+            read_around_skipped([&](std::size_t n) { reader.read(buffer.data(), n); });
+        }
+        REQUIRE(file.resident_pages(skipped_size, skipped_offset) == skipped_pages);
+        REQUIRE(file.resident_pages(1 << 16) == 0);
+
+        ::lseek(file.fd(), 0, SEEK_SET);
+        {
+            scope(streaming, file.fd());
+            read_around_skipped([&](std::size_t n) { REQUIRE(::read(file.fd(), buffer.data(), n) > 0); });
+        }
+        REQUIRE(file.resident_pages(skipped_size, skipped_offset) == skipped_pages);
+        REQUIRE(file.resident_pages(1 << 16) == 0);
+        REQUIRE(file.resident_pages(1 << 16, 6 << 20) == 0);
+    }
+
+    SECTION("without the guard the file stays cached")
+    {
+        std::vector<char> buffer(1 << 20);
+        while (::read(file.fd(), buffer.data(), buffer.size()) > 0)
+        {
+        }
+        REQUIRE(file.resident_pages() * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) == file_size);
+    }
+}
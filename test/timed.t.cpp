@@ -0,0 +1,142 @@
+#include <scope_exit/timed.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using scope_exit_v1::timed;
+using scope_exit_v1::timed_stats;
+
+namespace
+{
+
+int sleep_line = 0;
+int spin_line = 0;
+
+void sleeper()
+{
+    sleep_line = __LINE__ + 1;
+    scope(timed);
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+}
+
+void spinner()
+{
+    spin_line = __LINE__ + 1;
+    scope(timed);
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds{20};
+    while (std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+timed_stats find_site(int line)
+{
+    for (auto const & s : timed::sites())
+    {
+        if (s.line == line)
+        {
+            return s;
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+TEST_CASE("timed scopes split wall time into on- and off-CPU time", "[timed]")
+{
+    timed::set_sample_period(1);
+    for (int i = 0; i != 3; ++i)
+    {
+        sleeper();
+        spinner();
+    }
+
+    auto const sleep = find_site(sleep_line);
+    auto const spin = find_site(spin_line);
+    REQUIRE(sleep.count == 3);
+    REQUIRE(spin.count == 3);
+
+    SECTION("a sleeping scope is mostly off the CPU")
+    {
+        CHECK(sleep.wall_ns >= 60'000'000u);
+        CHECK(sleep.off_cpu_ns() > 4 * sleep.cpu_ns);
+        CHECK(sleep.max_wall_ns >= 20'000'000u);
+    }
+
+    SECTION("a spinning scope is mostly on the CPU")
+    {
+        CHECK(spin.wall_ns >= 60'000'000u);
+        // the sandbox may preempt us, but most of the time must be on the CPU
+        CHECK(spin.cpu_ns > spin.off_cpu_ns());
+    }
+
+    SECTION("sampled scopes count context switches")
+    {
+        CHECK(sleep.sampled == 3);
+        CHECK(sleep.voluntary_switches >= 3);
+        CHECK(spin.sampled == 3);
+    }
+
+    SECTION("the report lists both sites, most off-CPU time first")
+    {
+        std::FILE * out = std::tmpfile();
+        REQUIRE(out != nullptr);
+        timed::report(out);
+        std::rewind(out);
+        std::string text;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof buffer, out) != nullptr)
+        {
+            text += buffer;
+        }
+        std::fclose(out);
+
+        auto sleep_at = text.find("timed.t.cpp:" + std::to_string(sleep_line));
+        auto spin_at = text.find("timed.t.cpp:" + std::to_string(spin_line));
+        REQUIRE(sleep_at != std::string::npos);
+        REQUIRE(spin_at != std::string::npos);
+        CHECK(sleep_at < spin_at);
+    }
+
+    timed::reset();
+    CHECK(find_site(sleep_line).count == 0);
+    timed::set_sample_period(SCOPE_EXIT_TIMED_SAMPLE);
+}
+
+TEST_CASE("timed scopes on several threads", "[timed][threads]")
+{
+    std::atomic<int> line{0};
+    auto work = [&line] {
+        line = __LINE__ + 1;
+        scope(timed);
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    };
+    work();
+    timed::reset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i != 10; ++i)
+            {
+                work();
+            }
+        });
+    }
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+
+    auto const s = find_site(line);
+    CHECK(s.count == 40);
+    CHECK(s.wall_ns >= 40'000'000u);
+}